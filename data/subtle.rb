@@ -37,6 +37,9 @@ set :resize, false
 # Enable gravity tiling
 set :tiling, false
 
+# Move and resize windows directly instead of drawing a frame
+set :opaque, false
+
 # Font string either take from e.g. xfontsel or use xft
 set :font, "-*-*-medium-*-*-*-14-*-*-*-*-*-*-*"
 #set :font, "xft:sans-8"
@@ -47,6 +50,10 @@ set :separator, "|"
 # Set the WM_NAME of subtle (Java quirk)
 # set :wmname, "LG3D"
 
+# Log profile stats of all sublets and X request stats every n seconds,
+# see subtler -s -P and subtler -P
+# set :sublet_stats, 300
+
 #
 # == Screen
 #
@@ -719,6 +726,13 @@ view "dev",   "editor"
 # [*interval*]    Update interval of the sublet
 # [*foreground*]  Default foreground color
 # [*background*]  Default background color
+# [*process*]     Run sublet in a helper process, either true or the
+#                 time in seconds a call may take before the helper gets
+#                 killed (default: interval)
+# [*budget*]      Time in ms a call should take (default: 1000). Slower
+#                 runs back off the interval, calls taking four times as
+#                 long are interrupted and the sublet is unloaded after
+#                 three hangs in a row
 #
 # sur can also give a brief overview about properties:
 #
@@ -738,6 +752,29 @@ view "dev",   "editor"
 #    format_string "%H:%M:%S"
 #  end
 #
+# === Native sublets
+#
+# subtle ships some sublets written in C that can be added to a panel like
+# any other sublet: *:clock*, *:cpu*, *:memory*, *:battery* and *:network*.
+# They are only loaded when no Ruby sublet with the same name exists.
+#
+# Further native sublets can be placed as shared objects in
+# $XDG_DATA_HOME/subtle/plugins/<name>.so and must export a SubNative struct
+# (see src/subtle/native.h) named *subtle_native*. They can use
+# subMetricsGet() to share the system metrics sampled by subtle.
+#
+# === Metrics
+#
+# Sublets can use Subtle::Metrics to read cpu, memory, network and battery
+# values instead of parsing /proc themselves. Every source is sampled at most
+# once per second and shared by all sublets.
+#
+#  on :run do |s|
+#    s.data = "%d%% %dM" % [
+#      Subtle::Metrics.cpu, Subtle::Metrics.memory[:used] / 1024
+#    ]
+#  end
+#
 #  === Link
 #
 # http://subforge.org/projects/subtle/wiki/Sublets
@@ -65,6 +65,7 @@ module Subtle # {{{
           [ "--screen",  "-n", GetoptLong::NO_ARGUMENT ],
           [ "--raise",   "-E", GetoptLong::NO_ARGUMENT ],
           [ "--lower",   "-L", GetoptLong::NO_ARGUMENT ],
+          [ "--stats",   "-P", GetoptLong::NO_ARGUMENT ],
 
           # Modifiers
           [ "--reload",  "-r", GetoptLong::NO_ARGUMENT ],
@@ -119,6 +120,7 @@ module Subtle # {{{
             when "--gravity" then @action = :gravity=
             when "--raise"   then @action = :raise
             when "--lower"   then @action = :lower
+            when "--stats"   then @action = :stats
 
             # Modifiers
             when "--reload"  then @mod = :reload
@@ -179,6 +181,52 @@ module Subtle # {{{
             arg1 = Subtlext::Subtle.select_window
         end
 
+        # Sublet stats
+        if(Subtlext::Sublet == @group and :stats == @action)
+          sublets = arg1.nil? ? Subtlext::Sublet.all :
+            [ Subtlext::Sublet.find(arg1) ].flatten.compact
+
+          sublets.each do |s|
+            stats = s.stats or next
+
+            puts "%-15.15s %6d %8d %8d %8d %8d %8d %8d" % [
+              s.name, stats[:calls], stats[:cpu_ms], stats[:wall_ms],
+              stats[:wall], stats[:max], stats[:allocs], stats[:render]
+            ]
+          end
+
+          # Idle garbage collection
+          if(arg1.nil? and (stats = Subtlext::Subtle.gc_stats))
+            puts "%-15.15s %6d %8s %8d %8d %8d %8d %8s" % [
+              "[gc]", stats[:runs], "-", stats[:wall_ms], stats[:wall],
+              stats[:max], stats[:allocs], "-"
+            ]
+          end
+
+          return
+        end
+
+        # X request stats
+        if(@group.nil? and :stats == @action)
+          (Subtlext::Subtle.x_stats || {}).each do |name, stats|
+            next if(0 == stats[:calls])
+
+            puts "%-17.17s %8d %8d %8d %8d" % [
+              name, stats[:calls], stats[:requests], stats[:roundtrips],
+              stats[:max]
+            ]
+          end
+
+          # Event latency
+          (Subtlext::Subtle.latency_stats || {}).sort.each do |name, stats|
+            puts "%-40.40s %8d %8d %8d %8d" % [
+              name, stats[:count], stats[:p50], stats[:p99], stats[:max]
+            ]
+          end
+
+          return
+        end
+
         # Call method
         if(!@group.nil? and !@action.nil?)
           # Check singleton and instance methods
@@ -309,6 +357,7 @@ module Subtle # {{{
   Generic:
     -d, --display=DISPLAY   Connect to DISPLAY (default: #{ENV["DISPLAY"]})
     -h, --help              Show this help and exit
+    -P, --stats             Show X request and latency stats of subtle
     -V, --version           Show version info and exit
 
   Modifier:
@@ -378,6 +427,7 @@ EOF
     -l, --list              List all sublets
     -u, --update            Updates value of sublet
     -D, --data              Set data of sublet
+    -P, --stats             Show profile stats of sublets and GC
     -k, --kill=PATTERN      Kill sublet
 
 EOF
@@ -435,6 +485,10 @@ EOF
   Listings:
     Client listing:  <window id> [-*] <view id> <geometry> <gravity> <flags> <name> (<class>)
     Gravity listing: <gravity id> <geometry>
+    Sublet stats:    <name> <calls> <cpu ms> <wall ms> <avg wall us> <max wall us> <avg allocs> <avg render us>
+                     [gc] <runs> - <wall ms> <avg wall us> <max wall us> <avg allocs> -
+    X stats:         <operation> <calls> <requests> <round trips> <max requests>
+    Latency stats:   <event> <count> <p50 us> <p99 us> <max us>
     Screen listing:  <screen id> <geometry>
     Tag listing:     <name>
     View listing:    <window id> [-*] <view id> <name>
@@ -0,0 +1,503 @@
+
+ /**
+  * @package subtle
+  *
+  * @file Micro benchmarks
+  * @copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  **/
+
+#include <time.h>
+#include <math.h>
+#include "subtle.h"
+
+/* Macros */
+#define BENCH_RUNS    21                                          ///< Measured runs per case
+#define BENCH_TARGET  20000000ULL                                 ///< Min run time in nsec
+#define BENCH_ELEMS   256                                         ///< Array elements
+#define BENCH_TAGS    128                                         ///< Tag set size
+#define BENCH_CLIENTS 200                                         ///< Client count
+#define BENCH_PANELS  24                                          ///< Panels per screen
+#define BENCH_BURST   7                                           ///< Coalesce burst length
+
+/* Typedefs */
+typedef struct benchcase_t /* {{{ */
+{
+  const char *name;                                               ///< Case name
+  void       (*run)(unsigned long n);                             ///< Run case n times
+  int        x;                                                   ///< Case needs X
+} BenchCase; /* }}} */
+
+/* Globals */
+static volatile unsigned long sink = 0;
+static unsigned long seed = 1;
+static SubArray *elems = NULL, *tags = NULL;
+static SubClient *clients = NULL;
+static SubFont *font = NULL;
+static SubText *text = NULL;
+static XEvent burst[BENCH_BURST];
+
+/* BenchRandom {{{ */
+static unsigned long
+BenchRandom(void)
+{
+  /* Fixed seed LCG keeps data identical between runs */
+  seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+
+  return seed >> 33;
+} /* }}} */
+
+/* BenchClock {{{ */
+static unsigned long long
+BenchClock(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+} /* }}} */
+
+/* BenchCompare {{{ */
+static int
+BenchCompare(const void *a,
+  const void *b)
+{
+  double d1 = *(const double *)a, d2 = *(const double *)b;
+
+  return d1 < d2 ? -1 : (d1 > d2);
+} /* }}} */
+
+/* Cases */
+
+/* BenchArrayPush {{{ */
+static void
+BenchArrayPush(unsigned long n)
+{
+  unsigned long i;
+  SubArray *a = subArrayNew();
+
+  for(i = 0; i < n; i++)
+    {
+      if(BENCH_ELEMS == a->ndata) subArrayClear(a, False);
+
+      subArrayPush(a, elems->data[i % BENCH_ELEMS]);
+    }
+
+  subArrayKill(a, False);
+} /* }}} */
+
+/* BenchArrayRemove {{{ */
+static void
+BenchArrayRemove(unsigned long n)
+{
+  unsigned long i;
+
+  /* Remove from middle and add again at the end */
+  for(i = 0; i < n; i++)
+    {
+      void *elem = elems->data[BENCH_ELEMS / 2];
+
+      subArrayRemove(elems, elem);
+      subArrayPush(elems, elem);
+    }
+} /* }}} */
+
+/* BenchArrayIndex {{{ */
+static void
+BenchArrayIndex(unsigned long n)
+{
+  unsigned long i;
+
+  for(i = 0; i < n; i++)
+    sink += subArrayIndex(elems, (void *)((i * 7) % BENCH_ELEMS + 1));
+} /* }}} */
+
+/* BenchTextParse {{{ */
+static void
+BenchTextParse(unsigned long n)
+{
+  unsigned long i;
+  char buf[256];
+  const char *sublet = "#0x757575<>cpu: <>#0xe1e1e1<>12% <>#0x757575<>"
+    "mem: <>#0xe1e1e1<>1.2G/3.8G <>#0x757575<>wifi: <>#0xe1e1e1<>"
+    "wlan0 54% <>#0x757575<>Mon Jan 03 12:34";
+
+  /* Parse modifies the string, copy is part of the case */
+  for(i = 0; i < n; i++)
+    {
+      strncpy(buf, sublet, sizeof(buf));
+
+      sink += subSharedTextParse(subtle->dpy, font, text, buf);
+    }
+} /* }}} */
+
+/* BenchTagMatch {{{ */
+static void
+BenchTagMatch(unsigned long n)
+{
+  int j;
+  unsigned long i;
+
+  /* Check whole tag set like retagging a client */
+  for(i = 0; i < n; i++)
+    {
+      SubClient *c = &clients[i % BENCH_CLIENTS];
+
+      for(j = 0; j < tags->ndata; j++)
+        sink += subTagMatcherCheck(TAG(tags->data[j]), c);
+    }
+} /* }}} */
+
+/* BenchGrabFind {{{ */
+static void
+BenchGrabFind(unsigned long n)
+{
+  unsigned long i;
+
+  /* Codes and states are mixed hits and misses */
+  for(i = 0; i < n; i++)
+    sink += (unsigned long)subGrabFind(8 + (i * 13) % 248,
+      (i & 1) ? Mod4Mask : Mod1Mask|ShiftMask);
+} /* }}} */
+
+/* BenchEventMatch {{{ */
+static void
+BenchEventMatch(unsigned long n)
+{
+  int j, dirs[] = { SUB_GRAB_DIRECTION_UP, SUB_GRAB_DIRECTION_RIGHT,
+    SUB_GRAB_DIRECTION_DOWN, SUB_GRAB_DIRECTION_LEFT };
+  unsigned long i;
+
+  /* Find nearest client in direction like focus grabs do */
+  for(i = 0; i < n; i++)
+    {
+      int match = 0, distance = 1L << 16;
+      SubClient *c = &clients[i % BENCH_CLIENTS];
+
+      for(j = 0; j < BENCH_CLIENTS; j++)
+        {
+          int d = subEventMatch(dirs[i % 4], &c->geom, &clients[j].geom);
+
+          if(c != &clients[j] && d < distance)
+            {
+              distance = d;
+              match    = j;
+            }
+        }
+
+      sink += match;
+    }
+} /* }}} */
+
+/* BenchEventCoalesce {{{ */
+static void
+BenchEventCoalesce(unsigned long n)
+{
+  unsigned long i;
+  XEvent events[BENCH_BURST];
+
+  /* Coalesce interleaved burst of two clients */
+  for(i = 0; i < n; i++)
+    {
+      memcpy(events, burst, sizeof(burst));
+
+      sink += subEventCoalesce(events, BENCH_BURST);
+    }
+} /* }}} */
+
+/* BenchEventCheck {{{ */
+static int
+BenchEventCheck(void)
+{
+  XEvent events[BENCH_BURST];
+  XConfigureRequestEvent *a = &events[3].xconfigurerequest;
+  XConfigureRequestEvent *b = &events[5].xconfigurerequest;
+
+  memcpy(events, burst, sizeof(burst));
+
+  /* Only older events of the same client are folded */
+  return 3 == subEventCoalesce(events, BENCH_BURST) &&
+    0 == events[0].type && 0 == events[1].type && 0 == events[2].type &&
+    PropertyNotify == events[4].type && PropertyNotify == events[6].type &&
+    (CWX|CWY|CWWidth) == a->value_mask &&
+    10 == a->x && 20 == a->y && 100 == a->width &&
+    (CWX|CWWidth) == b->value_mask && 5 == b->x && 300 == b->width;
+} /* }}} */
+
+/* BenchScreenUpdate {{{ */
+static void
+BenchScreenUpdate(unsigned long n)
+{
+  unsigned long i;
+
+  for(i = 0; i < n; i++)
+    {
+      /* Change a sublet width like a data update does */
+      SubPanel *p = PANEL(SCREEN(subtle->screens->data[0])->panels->data[i %
+        BENCH_PANELS]);
+
+      p->sublet->width = 20 + i % 40;
+
+      subScreenUpdate();
+
+      sink += p->x;
+    }
+} /* }}} */
+
+/* Setup */
+
+/* BenchSetup {{{ */
+static void
+BenchSetup(void)
+{
+  int i, j;
+  char buf[64];
+
+  subtle = (SubSubtle *)subSharedMemoryAlloc(1, sizeof(SubSubtle));
+
+  subtle->grabs   = subArrayNew();
+  subtle->screens = subArrayNew();
+  subtle->clients = subArrayNew();
+  subtle->separator.width = 5;
+
+  /* Array elements are just numbers */
+  elems = subArrayNew();
+
+  for(i = 0; i < BENCH_ELEMS; i++)
+    subArrayPush(elems, (void *)(long)(i + 1));
+
+  /* Tags match name, instance, class or a combination of them */
+  tags = subArrayNew();
+
+  for(i = 0; i < BENCH_TAGS; i++)
+    {
+      SubTag *t = NULL;
+
+      snprintf(buf, sizeof(buf), "tag%d", i);
+      t = subTagNew(buf, NULL);
+
+      snprintf(buf, sizeof(buf), "^(app%d|tool%d)$", i, i + 1);
+      subTagMatcherAdd(t, 0 == i % 3 ? SUB_TAG_MATCH_INSTANCE :
+        SUB_TAG_MATCH_CLASS|SUB_TAG_MATCH_INSTANCE, buf, False, False);
+
+      if(0 == i % 4)
+        {
+          snprintf(buf, sizeof(buf), "- %d - ", i);
+          subTagMatcherAdd(t, SUB_TAG_MATCH_NAME, buf, True, False);
+        }
+
+      subArrayPush(tags, (void *)t);
+    }
+
+  /* Clients with random geometry */
+  clients = (SubClient *)subSharedMemoryAlloc(BENCH_CLIENTS,
+    sizeof(SubClient));
+
+  for(i = 0; i < BENCH_CLIENTS; i++)
+    {
+      SubClient *c = &clients[i];
+
+      c->flags       = SUB_TYPE_CLIENT|SUB_CLIENT_TYPE_NORMAL;
+      c->geom.x      = BenchRandom() % 1800;
+      c->geom.y      = BenchRandom() % 1000;
+      c->geom.width  = 50 + BenchRandom() % 600;
+      c->geom.height = 50 + BenchRandom() % 400;
+
+      snprintf(buf, sizeof(buf), "%s%lu",
+        i % 2 ? "app" : "tool", BenchRandom() % (2 * BENCH_TAGS));
+      c->instance = strdup(buf);
+      c->klass    = strdup(buf);
+
+      snprintf(buf, sizeof(buf), "title - %d - document", i);
+      c->name = strdup(buf);
+    }
+
+  /* Sorted grabs like after config load */
+  for(i = 0; i < 248; i += 2)
+    {
+      unsigned int states[] = { Mod4Mask, Mod4Mask|ShiftMask, Mod1Mask };
+
+      for(j = 0; j < LENGTH(states); j++)
+        {
+          SubGrab *g = GRAB(subSharedMemoryAlloc(1, sizeof(SubGrab)));
+
+          g->flags = SUB_TYPE_GRAB|SUB_GRAB_KEY;
+          g->code  = 8 + i;
+          g->state = states[j];
+
+          subArrayPush(subtle->grabs, (void *)g);
+        }
+    }
+
+  subArraySort(subtle->grabs, subGrabCompare);
+
+  /* Two screens with sublet panels, spacers, separators and center */
+  for(i = 0; i < 2; i++)
+    {
+      SubScreen *s = SCREEN(subSharedMemoryAlloc(1, sizeof(SubScreen)));
+
+      /* Skip subScreenNew, it creates panel windows */
+      s->flags       = SUB_TYPE_SCREEN;
+      s->geom.x      = 1920 * i;
+      s->geom.width  = 1920;
+      s->geom.height = 1080;
+      s->base        = s->geom;
+      s->panels      = subArrayNew();
+
+      for(j = 0; j < BENCH_PANELS; j++)
+        {
+          SubPanel *p = PANEL(subSharedMemoryAlloc(1, sizeof(SubPanel)));
+
+          p->flags  = SUB_TYPE_PANEL|SUB_PANEL_SUBLET;
+          p->screen = s;
+          p->sublet = (SubSublet *)subSharedMemoryAlloc(1, sizeof(SubSublet));
+          p->sublet->width = 20 + j * 3;
+
+          if(0 == j % 5) p->flags |= SUB_PANEL_SPACER1;
+          if(0 == j % 3) p->flags |= SUB_PANEL_SEPARATOR2;
+          if(BENCH_PANELS / 3 == j || 2 * BENCH_PANELS / 3 == j)
+            p->flags |= SUB_PANEL_CENTER;
+          if(BENCH_PANELS / 2 <= j) p->flags |= SUB_PANEL_BOTTOM;
+
+          subArrayPush(s->panels, (void *)p);
+        }
+
+      subArrayPush(subtle->screens, (void *)s);
+    }
+
+  /* Two clients with interleaved requests, parent is root for both */
+  for(i = 0; i < BENCH_BURST; i++)
+    {
+      const int types[] = { ConfigureRequest, ConfigureRequest,
+        PropertyNotify, ConfigureRequest, PropertyNotify, ConfigureRequest,
+        PropertyNotify };
+      const Window wins[] = { 2, 3, 2, 2, 3, 3, 2 };
+
+      if(ConfigureRequest == (burst[i].type = types[i]))
+        {
+          burst[i].xconfigurerequest.parent = 1;
+          burst[i].xconfigurerequest.window = wins[i];
+        }
+      else
+        {
+          burst[i].xproperty.window = wins[i];
+          burst[i].xproperty.atom   = XA_WM_NAME;
+        }
+    }
+
+  burst[0].xconfigurerequest.value_mask = CWX|CWY;
+  burst[0].xconfigurerequest.x          = 10;
+  burst[0].xconfigurerequest.y          = 20;
+  burst[1].xconfigurerequest.value_mask = CWWidth;
+  burst[1].xconfigurerequest.width      = 300;
+  burst[3].xconfigurerequest.value_mask = CWWidth;
+  burst[3].xconfigurerequest.width      = 100;
+  burst[5].xconfigurerequest.value_mask = CWX;
+  burst[5].xconfigurerequest.x          = 5;
+
+  /* Text parsing needs a font */
+  if((subtle->dpy = XOpenDisplay(NULL)))
+    {
+      if((font = subSharedFontNew(subtle->dpy, DEFFONT)))
+        text = subSharedTextNew();
+    }
+} /* }}} */
+
+/* BenchRun {{{ */
+static void
+BenchRun(BenchCase *bc)
+{
+  int i;
+  unsigned long n = 1;
+  unsigned long long start = 0, elapsed = 0;
+  double ns[BENCH_RUNS], mean = 0.0, var = 0.0;
+
+  /* Scale iterations to target time; this also warms up caches */
+  while(1)
+    {
+      start = BenchClock();
+      bc->run(n);
+      elapsed = BenchClock() - start;
+
+      if(BENCH_TARGET <= elapsed) break;
+
+      n = 0 < elapsed && BENCH_TARGET / 2 < elapsed ?
+        n * BENCH_TARGET / elapsed + 1 : n * 2;
+    }
+
+  /* Measure */
+  for(i = 0; i < BENCH_RUNS; i++)
+    {
+      start = BenchClock();
+      bc->run(n);
+      ns[i] = (double)(BenchClock() - start) / n;
+
+      mean += ns[i];
+    }
+
+  mean /= BENCH_RUNS;
+
+  for(i = 0; i < BENCH_RUNS; i++)
+    var += (ns[i] - mean) * (ns[i] - mean);
+
+  qsort(ns, BENCH_RUNS, sizeof(double), BenchCompare);
+
+  printf("%-16s %10lu %10.1f %10.1f %10.1f %10.1f %6.2f%%\n",
+    bc->name, n, ns[0], ns[BENCH_RUNS / 2], mean, ns[BENCH_RUNS - 1],
+    0.0 < mean ? 100.0 * sqrt(var / (BENCH_RUNS - 1)) / mean : 0.0);
+  fflush(stdout);
+} /* }}} */
+
+/* main {{{ */
+int
+main(int argc,
+  char *argv[])
+{
+  int i, j;
+  BenchCase cases[] =
+  {
+    { "array_push",     BenchArrayPush,     False },
+    { "array_remove",   BenchArrayRemove,   False },
+    { "array_index",    BenchArrayIndex,    False },
+    { "text_parse",     BenchTextParse,     True  },
+    { "tag_match",      BenchTagMatch,      False },
+    { "grab_find",      BenchGrabFind,      False },
+    { "event_match",    BenchEventMatch,    False },
+    { "event_coalesce", BenchEventCoalesce, False },
+    { "screen_update",  BenchScreenUpdate,  False }
+  };
+
+  BenchSetup();
+
+  /* Verify before measuring */
+  if(!BenchEventCheck())
+    {
+      fprintf(stderr, "event_coalesce: Merged requests of different clients\n");
+
+      return 1;
+    }
+
+  printf("# %d runs, times in nsec per op\n", BENCH_RUNS);
+  printf("%-16s %10s %10s %10s %10s %10s %7s\n",
+    "name", "n", "min", "median", "mean", "max", "rsd");
+
+  /* Run all or selected cases */
+  for(i = 0; i < LENGTH(cases); i++)
+    {
+      for(j = 1; j < argc && 0 != strcmp(argv[j], cases[i].name); j++);
+
+      if(1 < argc && j == argc) continue;
+
+      if(cases[i].x && !text)
+        printf("%-16s skipped, no display or font\n", cases[i].name);
+      else BenchRun(&cases[i]);
+    }
+
+  return 0;
+} /* }}} */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker
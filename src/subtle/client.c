@@ -10,6 +10,7 @@
   * See the file COPYING for details.
   **/
 
+#include <sys/poll.h>
 #include <X11/Xatom.h>
 #include "subtle.h"
 
@@ -31,6 +32,10 @@ typedef struct clientmwmhints_t
 } ClientMWMHints;
 /* }}} */
 
+/* Globals */
+static Window *list = NULL, *stack = NULL;
+static int nlist = 0, nstack = 0, restacked = False;
+
 /* Private */
 
 /* ClientMask {{{ */
@@ -71,6 +76,26 @@ ClientGravity(void)
   return grav;
 } /* }}} */
 
+/* ClientFrame {{{ */
+static unsigned long long
+ClientFrame(void)
+{
+  /* Refresh rate is updated on screen changes */
+  return 1000000ULL / (0 < subtle->rate ? subtle->rate : 60); ///< Frame time in microseconds
+} /* }}} */
+
+/* ClientWait {{{ */
+static int
+ClientWait(unsigned long long deadline)
+{
+  unsigned long long now = subSubtleClock(CLOCK_MONOTONIC);
+  struct pollfd pfd = { ConnectionNumber(subtle->dpy), POLLIN, 0 };
+
+  /* Wait for new events until deadline */
+  return (now < deadline &&
+    0 < poll(&pfd, 1, (int)((deadline - now) / 1000) + 1));
+} /* }}} */
+
 /* ClientBounds {{{ */
 static void
 ClientBounds(SubClient *c,
@@ -174,6 +199,7 @@ ClientTile(int gravity,
   int screen)
 {
   int i, used = 0, pos = 0, calc = 0, fix = 0;
+  unsigned long long start = 0;
   XRectangle geom = { 1 };
   SubScreen *s = SCREEN(subArrayGet(subtle->screens, screen));
   SubGravity *g = GRAVITY(subArrayGet(subtle->gravities, gravity));
@@ -190,6 +216,8 @@ ClientTile(int gravity,
 
   if(0 == used || !s || !g) return;
 
+  start = subTraceStart();
+
   /* Calculate tiled gravity value and rounding fix */
   subGravityGeometry(g, &(s->geom), &geom);
 
@@ -231,6 +259,8 @@ ClientTile(int gravity,
           ClientResize(c, &(s->geom));
         }
     }
+
+  subTraceSpan("client", "tile", NULL, start);
 } /* }}} */
 
 /* ClientZaphod {{{ */
@@ -270,54 +300,16 @@ ClientZaphod(SubClient *c,
     }
 } /* }}} */
 
-/* ClientCompare {{{ */
+/* ClientLayer {{{ */
 static int
-ClientCompare(const void *a,
-  const void *b)
+ClientLayer(SubClient *c)
 {
-  int ret = 0, dirret = 0;
-  SubClient *c1 = *(SubClient **)a, *c2 = *(SubClient **)b;
-
-  assert(a && b);
-
-  /* Direction is required when we change stacking on a level */
-  if(SUB_CLIENT_RESTACK_DOWN      == c1->dir) dirret = -1;
-  else if(SUB_CLIENT_RESTACK_UP   == c1->dir) dirret = 1;
-  else if(SUB_CLIENT_RESTACK_DOWN == c2->dir) dirret = 1;
-  else if(SUB_CLIENT_RESTACK_UP   == c2->dir) dirret = -1;
-
-  /* Complicated comparisons to ensure stacking order. Our desired
-   * order is following: desktop < gravity < float < full
-   *
-   * This function returns following values:
-   * -1 => c1 is on a lower level
-   *  0 => c1 and c2 are on the same level
-   *  1 => c1 is on a higher level */
-  if(c1->flags & SUB_CLIENT_TYPE_DESKTOP)
-    {
-      if(c2->flags & SUB_CLIENT_TYPE_DESKTOP) ret = dirret;
-      else ret = 0;
-    }
-  else if(c1->flags & SUB_CLIENT_MODE_FULL)
-    {
-      if(c2->flags & SUB_CLIENT_MODE_FULL) ret = dirret;
-      else ret = 1;
-    }
-  else if(c1->flags & SUB_CLIENT_MODE_FLOAT)
-    {
-      if(c2->flags & SUB_CLIENT_MODE_FULL) ret = -1;
-      else if(c2->flags & SUB_CLIENT_MODE_FLOAT) ret = dirret;
-      else ret = 1;
-    }
-  else
-    {
-      if(c2->flags & SUB_CLIENT_TYPE_DESKTOP) ret = 1;
-      else if(c2->flags & (SUB_CLIENT_MODE_FLOAT|
-          SUB_CLIENT_MODE_FULL)) ret = -1;
-      else ret = dirret;
-    }
+  /* Stacking layers: desktop < gravity < float < full */
+  if(c->flags & SUB_CLIENT_TYPE_DESKTOP)  return 0;
+  else if(c->flags & SUB_CLIENT_MODE_FULL)  return 3;
+  else if(c->flags & SUB_CLIENT_MODE_FLOAT) return 2;
 
-  return ret;
+  return 1;
 } /* }}} */
 
 /* Public */
@@ -337,19 +329,26 @@ subClientNew(Window win)
   XSetWindowAttributes sattrs;
   Window *leader = NULL;
   SubClient *c = NULL;
+  SubAccount mark;
 
   assert(win);
 
+  subDisplayMark(&mark);
+
   /* Check override_redirect */
   XGetWindowAttributes(subtle->dpy, win, &attrs);
-  if(True == attrs.override_redirect) return NULL;
+  if(True == attrs.override_redirect)
+    {
+      subDisplayAccount(SUB_ACCOUNT_CLIENT_NEW, &mark);
+
+      return NULL;
+    }
 
   /* Create new client */
   c = CLIENT(subSharedMemoryAlloc(1, sizeof(SubClient)));
   c->gravities = (int *)subSharedMemoryAlloc(subtle->views->ndata, sizeof(int));
   c->flags     = (SUB_TYPE_CLIENT|SUB_CLIENT_INPUT);
   c->gravity   = -1; ///< Force update
-  c->dir       = -1;
   c->win       = win;
 
   /* Window attributes */
@@ -412,6 +411,8 @@ subClientNew(Window win)
   subEwmhSetCardinals(c->win, SUB_EWMH_NET_WM_DESKTOP, &vid, 1);
   subEwmhSetCardinals(c->win, SUB_EWMH_NET_FRAME_EXTENTS, extents, 4);
 
+  subDisplayAccount(SUB_ACCOUNT_CLIENT_NEW, &mark);
+
   subSharedLogDebugSubtle("new=client, name=%s, instance=%s, "
     "class=%s, win=%#lx, input=%d, focus=%d\n",
     c->name, c->instance, c->klass, win, !!(c->flags & SUB_CLIENT_INPUT),
@@ -507,9 +508,13 @@ subClientRender(SubClient *c)
 void
 subClientFocus(SubClient *c)
 {
+  SubAccount mark;
+
   DEAD(c);
   assert(c);
 
+  subDisplayMark(&mark);
+
   /* Remove urgent after getting focus */
   if(c->flags & SUB_CLIENT_MODE_URGENT)
     {
@@ -525,6 +530,8 @@ subClientFocus(SubClient *c)
     }
   else if(c->flags & SUB_CLIENT_INPUT)
     XSetInputFocus(subtle->dpy, c->win, RevertToPointerRoot, CurrentTime);
+
+  subDisplayAccount(SUB_ACCOUNT_CLIENT_FOCUS, &mark);
 } /* }}} */
 
  /** subClientWarp {{{
@@ -556,11 +563,13 @@ subClientDrag(SubClient *c,
   int mode,
   int direction)
 {
-  XEvent ev;
+  XEvent ev, next;
   Window root = None, win = None;
   unsigned int mask = 0;
-  int loop = True, edge = 0, sx = 0, sy = 0;
+  int loop = True, edge = 0, sx = 0, sy = 0, bw = 0, pending = False;
   int wx = 0, wy = 0, ww = 0, wh = 0, rx = 0, ry = 0;
+  int opaque = (subtle->flags & SUB_SUBTLE_OPAQUE);
+  unsigned long long frame = 0, last = 0;
   SubScreen *s = NULL;
   XRectangle geom = { 0 };
   Cursor cursor;
@@ -599,10 +608,18 @@ subClientDrag(SubClient *c,
         break;
     } /* }}} */
 
-  /* Grab pointer server */
+  /* Opaque drags update the window once per frame */
+  if(opaque)
+    {
+      frame = ClientFrame();
+      bw    = c->flags & SUB_CLIENT_MODE_BORDERLESS ? 0 :
+        subtle->styles.clients.border.top;
+    }
+
+  /* Grab pointer and server (only needed for mask) */
   XGrabPointer(subtle->dpy, c->win, True, GRABMASK, GrabModeAsync,
     GrabModeAsync, None, cursor, CurrentTime);
-  XGrabServer(subtle->dpy);
+  if(!opaque) XGrabServer(subtle->dpy);
 
   switch(direction)
     {
@@ -645,12 +662,28 @@ subClientDrag(SubClient *c,
         ClientBounds(c, &(s->geom), &c->geom);
         break;
       default: /* {{{ */
-        ClientMask(&geom);
+        if(!opaque) ClientMask(&geom);
 
         /* Start event loop */
         while(loop)
           {
-            XMaskEvent(subtle->dpy, DRAGMASK, &ev);
+            /* Apply pending update when no event arrives in this frame */
+            if(pending && !XCheckMaskEvent(subtle->dpy, DRAGMASK, &ev))
+              {
+                if(!ClientWait(last + frame))
+                  {
+                    XMoveResizeWindow(subtle->dpy, c->win, geom.x - bw,
+                      geom.y - bw, geom.width, geom.height);
+                    XFlush(subtle->dpy);
+
+                    last    = subSubtleClock(CLOCK_MONOTONIC);
+                    pending = False;
+                  }
+
+                continue;
+              }
+            else if(!pending) XMaskEvent(subtle->dpy, DRAGMASK, &ev);
+
             switch(ev.type)
               {
                 case EnterNotify:   win = ev.xcrossing.window; break; ///< Find destination window
@@ -658,13 +691,18 @@ subClientDrag(SubClient *c,
                 case FocusIn:
                 case FocusOut:                                 break; ///< Ignore focus changes
                 case MotionNotify: /* {{{ */
+                  /* Skip stale motion events up to the next other event */
+                  while(XEventsQueued(subtle->dpy, QueuedAfterReading) &&
+                      (XPeekEvent(subtle->dpy, &next), MotionNotify == next.type))
+                    XNextEvent(subtle->dpy, &ev);
+
                   if(mode & (SUB_DRAG_MOVE|SUB_DRAG_RESIZE))
                     {
                       /* Check values */
                       if(!XYINRECT(ev.xmotion.x_root, ev.xmotion.y_root, s->geom))
                         continue;
 
-                      ClientMask(&geom);
+                      if(!opaque) ClientMask(&geom);
 
                       /* Calculate selection rect */
                       switch(mode)
@@ -707,13 +745,26 @@ subClientDrag(SubClient *c,
                             break; /* }}} */
                         }
 
-                      ClientMask(&geom);
+                      if(opaque) ///< Throttle to refresh rate
+                        {
+                          unsigned long long now =
+                            subSubtleClock(CLOCK_MONOTONIC);
+
+                          if((pending = (now < last + frame))) break;
+
+                          XMoveResizeWindow(subtle->dpy, c->win, geom.x - bw,
+                            geom.y - bw, geom.width, geom.height);
+                          XFlush(subtle->dpy);
+
+                          last = now;
+                        }
+                      else ClientMask(&geom);
                     }
                   break; /* }}} */
               }
           }
 
-        ClientMask(&geom); ///< Erase mask
+        if(!opaque) ClientMask(&geom); ///< Erase mask
 
         /* Subtract border width */
         if(!(c->flags & SUB_CLIENT_MODE_BORDERLESS))
@@ -730,7 +781,7 @@ subClientDrag(SubClient *c,
 
   /* Remove grabs */
   XUngrabPointer(subtle->dpy, CurrentTime);
-  XUngrabServer(subtle->dpy);
+  if(!opaque) XUngrabServer(subtle->dpy);
 } /* }}} */
 
  /** subClientTag {{{
@@ -798,10 +849,13 @@ subClientRetag(SubClient *c,
   int *flags)
 {
   int i, visible = 0;
+  SubAccount mark;
 
   DEAD(c);
   assert(c);
 
+  subDisplayMark(&mark);
+
   c->tags = 0; ///< Reset tags
 
   /* Check matching tags */
@@ -824,6 +878,8 @@ subClientRetag(SubClient *c,
 
   /* EWMH: Tags */
   subEwmhSetCardinals(c->win, SUB_EWMH_SUBTLE_CLIENT_TAGS, (long *)&c->tags, 1);
+
+  subDisplayAccount(SUB_ACCOUNT_CLIENT_RETAG, &mark);
 } /* }}} */
 
  /** subClientResize {{{
@@ -890,11 +946,46 @@ void
 subClientRestack(SubClient *c,
   int dir)
 {
-  c->dir = dir;
-  subArraySort(subtle->clients, ClientCompare);
-  c->dir = -1;
+  int i, n = 0, from = -1, to = -1, layer = 0;
+  XWindowChanges wc;
+
+  /* Skip clients that aren't managed yet */
+  if(-1 == (from = subArrayIndex(subtle->clients, (void *)c))) return;
+
+  layer = ClientLayer(c);
+  n     = subtle->clients->ndata - 1;
 
-  subClientPublish(True);
+  /* Remove client, layer may have changed */
+  for(i = from; i < n; i++)
+    subtle->clients->data[i] = subtle->clients->data[i + 1];
+
+  /* Find top or bottom of client layer: desktop < gravity < float < full */
+  if(SUB_CLIENT_RESTACK_UP == dir)
+    {
+      for(to = n; 0 < to &&
+        ClientLayer(CLIENT(subtle->clients->data[to - 1])) > layer; to--);
+    }
+  else
+    {
+      for(to = 0; to < n &&
+        ClientLayer(CLIENT(subtle->clients->data[to])) < layer; to++);
+    }
+
+  /* Insert client there */
+  for(i = n; i > to; i--)
+    subtle->clients->data[i] = subtle->clients->data[i - 1];
+
+  subtle->clients->data[to] = (void *)c;
+  restacked = True;
+
+  /* Restack only this window relative to its new neighbour */
+  if(1 < subtle->clients->ndata)
+    {
+      wc.sibling    = CLIENT(subtle->clients->data[0 < to ? to - 1 : 1])->win;
+      wc.stack_mode = 0 < to ? Above : Below;
+
+      XConfigureWindow(subtle->dpy, c->win, CWSibling|CWStackMode, &wc);
+    }
 
   subSharedLogDebugSubtle("Restack: instance=%s, win=%#lx, dir=%s\n",
     c->instance, c->win, SUB_CLIENT_RESTACK_DOWN == dir ? "down" : "up");
@@ -997,8 +1088,6 @@ subClientArrange(SubClient *c,
           /* Hook: Gravity */
           subHookCall((SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_GRAVITY),
             (void *)c);
-
-          XSync(subtle->dpy, False); ///< Sync all changes
         }
     }
 } /* }}} */
@@ -1162,8 +1251,6 @@ subClientToggle(SubClient *c,
 
   subEwmhSetCardinals(c->win, SUB_EWMH_SUBTLE_CLIENT_FLAGS, (long *)&flags, 1);
 
-  XSync(subtle->dpy, False); ///< Sync all changes
-
   /* Hook: Mode */
   subHookCall((SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_MODE), (void *)c);
 } /* }}} */
@@ -1579,8 +1666,8 @@ subClientClose(SubClient *c)
       XKillClient(subtle->dpy, c->win);
 
       subArrayRemove(subtle->clients, (void *)c);
+      subClientPublish(c, False);
       subClientKill(c);
-      subClientPublish(False);
 
       subScreenConfigure();
       subScreenUpdate();
@@ -1619,6 +1706,9 @@ subClientKill(SubClient *c)
   if(subtle->flags & SUB_SUBTLE_TILING)
     ClientTile(c->gravity, c->screen);
 
+  /* Release ruby object */
+  if(c->object) subRubyRelease(c->object);
+
   if(c->gravities) free(c->gravities);
   if(c->name)      free(c->name);
   if(c->instance)  free(c->instance);
@@ -1631,37 +1721,92 @@ subClientKill(SubClient *c)
 
 /* All */
 
- /** subClientPublish(False) {{{
-  * @brief Publish clients
-  * @param[in]  restack  Restack windows
+ /** subClientPublish {{{
+  * @brief Publish added or removed client
+  * @param[in]  c      A #SubClient
+  * @param[in]  added  Whether client was added or removed
   **/
 
 void
-subClientPublish(int restack)
+subClientPublish(SubClient *c,
+  int added)
 {
   int i;
-  Window *wins = (Window *)subSharedMemoryAlloc(subtle->clients->ndata,
-    sizeof(Window));
+
+  assert(c);
+
+  /* EWMH: Client list in mapping order */
+  if(added)
+    {
+      list = (Window *)subSharedMemoryRealloc(list,
+        (nlist + 1) * sizeof(Window));
+      list[nlist++] = c->win;
+
+      /* Replace leftovers of previous runs with first client */
+      XChangeProperty(subtle->dpy, ROOT,
+        subEwmhGet(SUB_EWMH_NET_CLIENT_LIST), XA_WINDOW, 32,
+        1 == nlist ? PropModeReplace : PropModeAppend,
+        (unsigned char *)&c->win, 1);
+    }
+  else
+    {
+      for(i = 0; i < nlist && list[i] != c->win; i++);
+
+      if(i == nlist) return;
+
+      /* Rewrite list without client */
+      memmove(&list[i], &list[i + 1], (--nlist - i) * sizeof(Window));
+
+      subEwmhSetWindows(ROOT, SUB_EWMH_NET_CLIENT_LIST, list, nlist);
+    }
+
+  restacked = True; ///< Publish stacking once per loop
+
+  subSharedLogDebugSubtle("publish=client, clients=%d, added=%d\n",
+    nlist, added);
+} /* }}} */
+
+ /** subClientPublishStacking {{{
+  * @brief Publish client stacking list if it changed
+  **/
+
+void
+subClientPublishStacking(void)
+{
+  int i, changed = False;
+
+  if(!restacked) return;
+
+  changed = (nstack != subtle->clients->ndata);
 
   /* Sort clients from top (=> 0) to bottom */
-  for(i = 0; i < subtle->clients->ndata; i++)
-    wins[subtle->clients->ndata - 1 - i] = CLIENT(subtle->clients->data[i])->win;
+  if(nstack < subtle->clients->ndata)
+    stack = (Window *)subSharedMemoryRealloc(stack,
+      subtle->clients->ndata * sizeof(Window));
+
+  nstack = subtle->clients->ndata;
 
-  /* EWMH: Client list and client list stacking (same for us) */
-  subEwmhSetWindows(ROOT, SUB_EWMH_NET_CLIENT_LIST, wins,
-    subtle->clients->ndata);
-  subEwmhSetWindows(ROOT, SUB_EWMH_NET_CLIENT_LIST_STACKING, wins,
-    subtle->clients->ndata);
+  for(i = 0; i < nstack; i++)
+    {
+      Window win = CLIENT(subtle->clients->data[i])->win;
 
-  /* Restack windows? We assembled the array anyway. */
-  if(restack) XRestackWindows(subtle->dpy, wins, subtle->clients->ndata);
+      if(stack[nstack - 1 - i] != win) changed = True;
 
-  XSync(subtle->dpy, False); ///< Sync all changes
+      stack[nstack - 1 - i] = win;
+    }
+
+  /* EWMH: Client list stacking */
+  if(changed)
+    {
+      subEwmhSetWindows(ROOT, SUB_EWMH_NET_CLIENT_LIST_STACKING,
+        stack, nstack);
+
+      subSharedLogDebugSubtle("publish=stacking, clients=%d\n", nstack);
+    }
 
-  free(wins);
+  XFlush(subtle->dpy);
 
-  subSharedLogDebugSubtle("publish=client, clients=%d, restack=%d\n",
-    subtle->clients->ndata, restack);
+  restacked = False;
 } /* }}} */
 
 // vim:ts=2:bs=2:sw=2:et:fdm=marker
@@ -0,0 +1,499 @@
+
+ /**
+  * @package subtle
+  *
+  * @file Control socket functions
+  * @copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  **/
+
+#include <unistd.h>
+#include <stdarg.h>
+#include <fcntl.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include "subtle.h"
+
+/* Macros */
+#define CONTROL_CONNS  16                                         ///< Max connections
+#define CONTROL_LINE   4096                                       ///< Max request length
+#define CONTROL_QUEUE  (1L << 20)                                 ///< Max unsent reply length
+
+/* Typedefs */
+typedef struct controlreply_t /* {{{ */
+{
+  char   *data;                                                   ///< Reply data
+  size_t len, size;                                               ///< Reply length, size
+} ControlReply; /* }}} */
+
+typedef struct controlconn_t /* {{{ */
+{
+  int          fd, eof;                                           ///< Connection descriptor, end of file
+  size_t       ninput;                                            ///< Buffered request length
+  char         input[CONTROL_LINE];                               ///< Request buffer
+  ControlReply output;                                            ///< Unsent replies
+} ControlConn; /* }}} */
+
+/* Globals */
+static int control = -1, nconns = 0;
+static ControlConn conns[CONTROL_CONNS];
+
+/* ControlReplyAdd {{{ */
+static void
+ControlReplyAdd(ControlReply *r,
+  const char *format,
+  ...)
+{
+  int len = 0;
+  va_list ap;
+
+  /* Grow until formatted string fits */
+  while(1)
+    {
+      va_start(ap, format);
+      len = vsnprintf(r->data + r->len, r->size - r->len, format, ap);
+      va_end(ap);
+
+      if(0 > len) return;
+      else if(r->len + len < r->size) break;
+
+      r->size = MAX(r->size * 2, r->len + len + 1);
+      r->data = (char *)subSharedMemoryRealloc(r->data, r->size);
+    }
+
+  r->len += len;
+} /* }}} */
+
+/* ControlMessage {{{ */
+static void
+ControlMessage(SubEwmh e,
+  long l0,
+  long l1,
+  long l2)
+{
+  XClientMessageEvent ev;
+
+  /* Handle like a message sent to root */
+  memset(&ev, 0, sizeof(ev));
+  ev.type         = ClientMessage;
+  ev.window       = ROOT;
+  ev.message_type = subEwmhGet(e);
+  ev.format       = 32;
+  ev.data.l[0]    = l0;
+  ev.data.l[1]    = l1;
+  ev.data.l[2]    = l2;
+
+  subEventMessage(&ev);
+} /* }}} */
+
+/* ControlName {{{ */
+static char *
+ControlName(void *data)
+{
+  /* Get name of tag, view or sublet */
+  if(TAG(data)->flags & SUB_TYPE_TAG) return TAG(data)->name;
+  else if(VIEW(data)->flags & SUB_TYPE_VIEW) return VIEW(data)->name;
+
+  return PANEL(data)->sublet->name;
+} /* }}} */
+
+/* ControlFind {{{ */
+static int
+ControlFind(SubArray *a,
+  const char *name)
+{
+  int i;
+
+  for(i = 0; name && i < a->ndata; i++)
+    if(0 == strcmp(ControlName(a->data[i]), name)) return i;
+
+  return -1;
+} /* }}} */
+
+/* ControlRequest {{{ */
+static void
+ControlRequest(char *line,
+  ControlReply *r)
+{
+  int i, id = -1;
+  char *cmd = NULL, *arg1 = NULL, *arg2 = NULL;
+  SubClient *c = NULL;
+
+  /* Split request into command, argument and remainder */
+  if(!(cmd = strtok(line, " "))) return;
+
+  arg1 = strtok(NULL, " ");
+  arg2 = strtok(NULL, "");
+
+  /* Queries */
+  if(0 == strcmp(cmd, "clients"))
+    {
+      ControlReplyAdd(r, "+%d\n", subtle->clients->ndata);
+
+      for(i = 0; i < subtle->clients->ndata; i++)
+        {
+          c = CLIENT(subtle->clients->data[i]);
+
+          ControlReplyAdd(r, "%#lx\t%d\t%s\t%s\t%s\n", c->win, c->tags,
+            c->instance ? c->instance : "", c->klass ? c->klass : "",
+            c->name ? c->name : "");
+        }
+    }
+  else if(0 == strcmp(cmd, "tags") || 0 == strcmp(cmd, "views") ||
+      0 == strcmp(cmd, "sublets"))
+    {
+      SubArray *a = 't' == *cmd ? subtle->tags :
+        ('v' == *cmd ? subtle->views : subtle->sublets);
+
+      ControlReplyAdd(r, "+%d\n", a->ndata);
+
+      for(i = 0; i < a->ndata; i++)
+        ControlReplyAdd(r, "%s\n", ControlName(a->data[i]));
+    }
+
+  /* Commands */
+  else if(0 == strcmp(cmd, "jump"))
+    {
+      if(-1 != (id = ControlFind(subtle->views, arg1)))
+        {
+          ControlMessage(SUB_EWMH_NET_CURRENT_DESKTOP, id, 0, -1);
+          ControlReplyAdd(r, "+OK\n");
+        }
+      else ControlReplyAdd(r, "-ERR no such view\n");
+    }
+  else if(0 == strcmp(cmd, "tag") || 0 == strcmp(cmd, "untag") ||
+      0 == strcmp(cmd, "retag"))
+    {
+      if(!arg1 || !(c = CLIENT(subSubtleFind(strtoul(arg1, NULL, 0),
+          CLIENTID))))
+        ControlReplyAdd(r, "-ERR no such client\n");
+      else if('r' == *cmd)
+        {
+          ControlMessage(SUB_EWMH_SUBTLE_CLIENT_RETAG, c->win, 0, 0);
+          ControlReplyAdd(r, "+OK\n");
+        }
+      else if(-1 != (id = ControlFind(subtle->tags, arg2)))
+        {
+          int tags = 't' == *cmd ? (c->tags | (1L << (id + 1))) :
+            (c->tags & ~(1L << (id + 1)));
+
+          ControlMessage(SUB_EWMH_SUBTLE_CLIENT_TAGS, c->win, tags, 0);
+          ControlReplyAdd(r, "+OK\n");
+        }
+      else ControlReplyAdd(r, "-ERR no such tag\n");
+    }
+  else if(0 == strcmp(cmd, "data"))
+    {
+      SubPanel *p = NULL;
+
+      if(-1 != (id = ControlFind(subtle->sublets, arg1)) &&
+          (p = PANEL(subtle->sublets->data[id])) &&
+          p->sublet->flags & SUB_SUBLET_DATA)
+        {
+          subRubyCall(SUB_CALL_DATA, p->sublet->instance,
+            arg2 ? arg2 : "");
+          subScreenUpdate();
+          subScreenRender();
+          ControlReplyAdd(r, "+OK\n");
+        }
+      else ControlReplyAdd(r, "-ERR no such data sublet\n");
+    }
+  else if(0 == strcmp(cmd, "reload"))
+    {
+      subtle->flags |= SUB_SUBTLE_RELOAD;
+      ControlReplyAdd(r, "+OK\n");
+    }
+  else ControlReplyAdd(r, "-ERR unknown command\n");
+} /* }}} */
+
+/* ControlClose {{{ */
+static void
+ControlClose(int idx)
+{
+  subEventWatchDel(conns[idx].fd);
+  close(conns[idx].fd);
+
+  if(conns[idx].output.data) free(conns[idx].output.data);
+
+  conns[idx] = conns[--nconns]; ///< Move last into gap
+} /* }}} */
+
+/* ControlFlush {{{ */
+static void
+ControlFlush(int idx)
+{
+  ssize_t n = 0;
+  ControlConn *conn = &conns[idx];
+  ControlReply *r = &conn->output;
+
+  /* Send as much as the socket takes right now */
+  if(0 < r->len)
+    {
+      if(0 > (n = send(conn->fd, r->data, r->len, MSG_NOSIGNAL)))
+        {
+          if(EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+            {
+              ControlClose(idx);
+
+              return;
+            }
+
+          n = 0;
+        }
+
+      r->len -= n;
+      memmove(r->data, r->data + n, r->len);
+    }
+
+  /* Drop connections that stop reading or are done */
+  if(CONTROL_QUEUE < r->len || (conn->eof && 0 == r->len))
+    {
+      if(!conn->eof)
+        subSharedLogDebug("Control: Dropping connection fd=%d\n", conn->fd);
+
+      ControlClose(idx);
+
+      return;
+    }
+
+  /* Wait for the socket to become writable for the rest */
+  subEventWatchEvents(conn->fd, (conn->eof ? 0 : POLLIN) |
+    (0 < r->len ? POLLOUT : 0));
+} /* }}} */
+
+/* ControlRead {{{ */
+static void
+ControlRead(int idx)
+{
+  ssize_t n = 0;
+  char *line = NULL, *end = NULL;
+  ControlConn *conn = &conns[idx];
+
+  /* Read available data */
+  if(!conn->eof && 0 < (n = read(conn->fd, conn->input + conn->ninput,
+      sizeof(conn->input) - conn->ninput)))
+    {
+      conn->ninput += n;
+
+      /* Answer all complete requests at once */
+      for(line = conn->input;
+          (end = memchr(line, '\n', conn->ninput - (line - conn->input)));
+          line = end + 1)
+        {
+          *end = '\0';
+
+          if(end > line && '\r' == *(end - 1)) *(end - 1) = '\0';
+
+          ControlRequest(line, &conn->output);
+        }
+
+      conn->ninput -= line - conn->input;
+      memmove(conn->input, line, conn->ninput);
+
+      /* Drop overlong requests */
+      if(sizeof(conn->input) == conn->ninput)
+        {
+          ControlReplyAdd(&conn->output, "-ERR request too long\n");
+          conn->ninput = 0;
+        }
+    }
+  else if(0 == n || (EAGAIN != errno && EINTR != errno))
+    conn->eof = True; ///< Send pending replies before closing
+
+  ControlFlush(idx);
+} /* }}} */
+
+/* ControlAccept {{{ */
+static void
+ControlAccept(void)
+{
+  int fd = -1;
+
+  if(-1 == (fd = accept(control, NULL, NULL))) return;
+
+  /* Limit connections */
+  if(CONTROL_CONNS == nconns)
+    {
+      subSharedLogWarn("Too many control connections\n");
+      close(fd);
+
+      return;
+    }
+
+  /* Never block the event loop; unsent replies wait for POLLOUT */
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  memset(&conns[nconns], 0, sizeof(ControlConn));
+  conns[nconns++].fd = fd;
+
+  subEventWatchAdd(fd);
+} /* }}} */
+
+/* ControlStale {{{ */
+static int
+ControlStale(struct sockaddr_un *addr)
+{
+  int fd = -1, alive = False;
+  struct stat sb;
+
+  /* Check for leftovers */
+  if(-1 == lstat(addr->sun_path, &sb))
+    {
+      if(ENOENT == errno) return True;
+
+      subSharedLogWarn("Failed checking control socket `%s': %s\n",
+        addr->sun_path, strerror(errno));
+
+      return False;
+    }
+
+  if(!S_ISSOCK(sb.st_mode))
+    {
+      subSharedLogWarn("Control socket path `%s' is no socket\n",
+        addr->sun_path);
+
+      return False;
+    }
+
+  /* Check if socket is still in use */
+  if(-1 != (fd = socket(AF_UNIX, SOCK_STREAM, 0)))
+    {
+      alive = (0 == connect(fd, (struct sockaddr *)addr, sizeof(*addr)));
+
+      close(fd);
+    }
+
+  if(alive)
+    {
+      subSharedLogWarn("Control socket `%s' is in use\n", addr->sun_path);
+
+      return False;
+    }
+
+  unlink(addr->sun_path); ///< Remove stale socket
+
+  return True;
+} /* }}} */
+
+ /** subControlInit {{{
+  * @brief Open control socket if requested
+  **/
+
+void
+subControlInit(void)
+{
+  int error = 0;
+  mode_t mask;
+  struct sockaddr_un addr;
+
+  if(!subtle->paths.socket) return;
+
+  /* Check path length */
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+
+  if(sizeof(addr.sun_path) <= strlen(subtle->paths.socket))
+    {
+      subSharedLogWarn("Control socket path `%s' too long\n",
+        subtle->paths.socket);
+
+      return;
+    }
+
+  strncpy(addr.sun_path, subtle->paths.socket, sizeof(addr.sun_path) - 1);
+
+  if(!ControlStale(&addr)) return;
+
+  /* Create socket only accessible by user */
+  mask = umask(077);
+
+  if(-1 == (control = socket(AF_UNIX, SOCK_STREAM, 0)) ||
+      -1 == bind(control, (struct sockaddr *)&addr, sizeof(addr)))
+    error = errno;
+
+  umask(mask);
+
+  if(error || -1 == listen(control, CONTROL_CONNS))
+    {
+      if(!error) error = errno;
+
+      subSharedLogWarn("Failed opening control socket `%s': %s\n",
+        subtle->paths.socket, strerror(error));
+
+      if(-1 != control) close(control);
+      control = -1;
+
+      return;
+    }
+
+  fcntl(control, F_SETFL, O_NONBLOCK);
+  fcntl(control, F_SETFD, FD_CLOEXEC);
+
+  subEventWatchAdd(control);
+
+  subSharedLogDebug("Control: path=%s, fd=%d\n", subtle->paths.socket,
+    control);
+} /* }}} */
+
+ /** subControlHandle {{{
+  * @brief Handle pending control socket data
+  * @param[in]  fd  Ready file descriptor
+  * @retval  1  Descriptor belongs to control socket
+  * @retval  0  Unknown descriptor
+  **/
+
+int
+subControlHandle(int fd)
+{
+  int i;
+
+  if(-1 == control) return False;
+
+  if(fd == control)
+    {
+      ControlAccept();
+
+      return True;
+    }
+
+  for(i = 0; i < nconns; i++)
+    {
+      if(conns[i].fd == fd)
+        {
+          ControlRead(i);
+
+          return True;
+        }
+    }
+
+  return False;
+} /* }}} */
+
+ /** subControlFinish {{{
+  * @brief Close control socket and connections
+  **/
+
+void
+subControlFinish(void)
+{
+  if(-1 != control)
+    {
+      while(0 < nconns) ControlClose(0);
+
+      subEventWatchDel(control);
+      close(control);
+      unlink(subtle->paths.socket);
+
+      control = -1;
+    }
+
+  subSharedLogDebugSubtle("finish=control\n");
+} /* }}} */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker
@@ -15,6 +15,34 @@
 #include <locale.h>
 #include "subtle.h"
 
+/* Globals */
+static unsigned long roundtrips = 0, lastread = 0;
+static int dirty = False;
+static time_t published = 0, logged = 0;
+static SubAccount accounts[SUB_ACCOUNT_TOTAL];
+static const char *names[] =
+{
+  "colormap", "configure", "configure_request", "crossing", "destroy",
+  "expose", "focus", "grab", "map", "map_request", "message", "property",
+  "selection", "unmap", "screen_configure", "screen_render", "client_new",
+  "client_focus", "client_retag", "view_switch", "reload"
+};
+
+/* DisplayAfter {{{ */
+static int
+DisplayAfter(Display *dpy)
+{
+  unsigned long read = LastKnownRequestProcessed(dpy);
+
+  /* Xlib calls this after every request; when the reply of the
+   * latest request has just been read, the call was a round trip */
+  if(read != lastread && read == NextRequest(dpy) - 1) roundtrips++;
+
+  lastread = read;
+
+  return 0;
+} /* }}} */
+
 /* DisplayClaim {{{ */
 int
 DisplayClaim(void)
@@ -144,6 +172,7 @@ subDisplayInit(const char *display)
     }
 
   XSetErrorHandler(subSharedLogXError);
+  XSetAfterFunction(subtle->dpy, DisplayAfter);
   setenv("DISPLAY", DisplayString(subtle->dpy), True); ///< Set display for clients
 
   /* Create GCs */
@@ -268,14 +297,17 @@ subDisplayScan(void)
         {
           case IsViewable:
             if((c = subClientNew(wins[i])))
-              subArrayPush(subtle->clients, (void *)c);
+              {
+                subArrayPush(subtle->clients, (void *)c);
+                subClientPublish(c, True);
+              }
             break;
         }
     }
 
   XFree(wins);
 
-  subClientPublish(False);
+  subClientPublishStacking();
 } /* }}} */
 
  /** subDisplayPublish {{{
@@ -324,11 +356,93 @@ subDisplayPublish(void)
 
   free(colors);
 
-  XSync(subtle->dpy, False); ///< Sync all changes
-
   subSharedLogDebugSubtle("publish=colors, n=%d\n", NCOLORS);
 } /* }}} */
 
+ /** subDisplayMark {{{
+  * @brief Remember current X request and round trip counters
+  * @param[inout]  mark  A #SubAccount
+  **/
+
+void
+subDisplayMark(SubAccount *mark)
+{
+  assert(mark);
+
+  mark->requests   = NextRequest(subtle->dpy);
+  mark->roundtrips = roundtrips;
+} /* }}} */
+
+ /** subDisplayAccount {{{
+  * @brief Account X requests and round trips since mark, nested
+  *        operations are included in their callers
+  * @param[in]  id    Account id
+  * @param[in]  mark  A #SubAccount
+  **/
+
+void
+subDisplayAccount(SubAccountId id,
+  SubAccount *mark)
+{
+  unsigned long requests = 0, trips = 0;
+  SubAccount *a = &accounts[id];
+
+  assert(mark && id < SUB_ACCOUNT_TOTAL);
+
+  requests = NextRequest(subtle->dpy) - mark->requests;
+  trips    = roundtrips - mark->roundtrips;
+
+  a->calls++;
+  a->requests   += requests;
+  a->roundtrips += trips;
+  a->max         = MAX(a->max, requests);
+
+  dirty = True;
+
+  if(0 < requests)
+    subSharedLogDebugEvents("Account: op=%s, requests=%lu, roundtrips=%lu\n",
+      names[id], requests, trips);
+} /* }}} */
+
+ /** subDisplayAccountPublish {{{
+  * @brief Publish X request stats at most once per second and log them
+  *        if enabled
+  **/
+
+void
+subDisplayAccountPublish(void)
+{
+  int i;
+  long stats[SUB_ACCOUNT_TOTAL * 4] = { 0 };
+  time_t now = 0;
+
+  /* Check for changes and throttle */
+  if(!dirty || (now = subSubtleTime()) == published) return;
+
+  for(i = 0; i < SUB_ACCOUNT_TOTAL; i++)
+    {
+      long *v = &stats[i * 4];
+
+      v[0] = accounts[i].calls;
+      v[1] = accounts[i].requests;
+      v[2] = accounts[i].roundtrips;
+      v[3] = accounts[i].max;
+
+      /* Dump stats */
+      if(0 < subtle->stats && now >= logged + subtle->stats && 0 < v[0])
+        printf("X stats (%s): calls=%ld, requests=%ld, roundtrips=%ld, "
+          "max=%ld\n", names[i], v[0], v[1], v[2], v[3]);
+    }
+
+  /* EWMH: X stats */
+  subEwmhSetCardinals(ROOT, SUB_EWMH_SUBTLE_X_STATS, stats, LENGTH(stats));
+
+  if(0 < subtle->stats && now >= logged + subtle->stats) logged = now;
+
+  dirty     = False;
+  published = now;
+} /* }}} */
+
  /** subDisplayFinish {{{
   * @brief Close connection
   **/
@@ -19,6 +19,8 @@
 #define BUFLEN (sizeof(struct inotify_event))
 #endif /* HAVE_SYS_INOTIFY_H */
 
+#define BURSTLEN 128 ///< Max events coalesced at once
+
 #ifdef HAVE_X11_EXTENSIONS_XRANDR_H
 #include <X11/extensions/Xrandr.h>
 #endif /* HAVE_X11_EXTENSIONS_XRANDR_H */
@@ -54,6 +56,75 @@ EventUntag(SubClient *c,
     }
 } /* }}} */
 
+/* EventRender {{{ */
+static void
+EventRender(void)
+{
+  unsigned long long start = subSubtleClock(CLOCK_MONOTONIC);
+
+  subScreenUpdate();
+  subScreenRender();
+
+  /* Blame render on updated sublets */
+  subPanelProfileRender(subSubtleClock(CLOCK_MONOTONIC) - start);
+} /* }}} */
+
+/* EventName {{{ */
+static const char *
+EventName(int type)
+{
+  static const char *names[LASTEvent] =
+  {
+    [ButtonPress]      = "ButtonPress",
+    [ClientMessage]    = "ClientMessage",
+    [ColormapNotify]   = "ColormapNotify",
+    [ConfigureNotify]  = "ConfigureNotify",
+    [ConfigureRequest] = "ConfigureRequest",
+    [DestroyNotify]    = "DestroyNotify",
+    [EnterNotify]      = "EnterNotify",
+    [Expose]           = "Expose",
+    [FocusIn]          = "FocusIn",
+    [KeyPress]         = "KeyPress",
+    [LeaveNotify]      = "LeaveNotify",
+    [MapNotify]        = "MapNotify",
+    [MapRequest]       = "MapRequest",
+    [PropertyNotify]   = "PropertyNotify",
+    [SelectionClear]   = "SelectionClear",
+    [UnmapNotify]      = "UnmapNotify"
+  };
+
+  return 0 <= type && LASTEvent > type && names[type] ?
+    names[type] : "Unknown";
+} /* }}} */
+
+/* EventAccount {{{ */
+static SubAccountId
+EventAccount(int type)
+{
+  /* Map event type to handler account */
+  switch(type)
+    {
+      case ColormapNotify:   return SUB_ACCOUNT_COLORMAP;
+      case ConfigureNotify:  return SUB_ACCOUNT_CONFIGURE;
+      case ConfigureRequest: return SUB_ACCOUNT_CONFIGURE_REQUEST;
+      case EnterNotify:
+      case LeaveNotify:      return SUB_ACCOUNT_CROSSING;
+      case DestroyNotify:    return SUB_ACCOUNT_DESTROY;
+      case Expose:           return SUB_ACCOUNT_EXPOSE;
+      case FocusIn:          return SUB_ACCOUNT_FOCUS;
+      case ButtonPress:
+      case KeyPress:         return SUB_ACCOUNT_GRAB;
+      case MapNotify:        return SUB_ACCOUNT_MAP;
+      case MapRequest:       return SUB_ACCOUNT_MAP_REQUEST;
+      case ClientMessage:    return SUB_ACCOUNT_MESSAGE;
+      case PropertyNotify:   return SUB_ACCOUNT_PROPERTY;
+      case SelectionClear:   return SUB_ACCOUNT_SELECTION;
+      case UnmapNotify:      return SUB_ACCOUNT_UNMAP;
+    }
+
+  return SUB_ACCOUNT_TOTAL;
+} /* }}} */
+
 /* EventFindSublet {{{ */
 static SubPanel *
 EventFindSublet(int id)
@@ -78,6 +149,46 @@ EventFindSublet(int id)
   return NULL;
 } /* }}} */
 
+/* EventSubletBatch {{{ */
+static void
+EventSubletBatch(void)
+{
+  int format = 0, updated = 0;
+  unsigned long nitems = 0, bytes = 0;
+  unsigned char *data = NULL;
+  Atom rtype = None;
+
+  /* Fetch and delete all records appended so far at once */
+  if(Success == XGetWindowProperty(subtle->dpy, ROOT,
+      subEwmhGet(SUB_EWMH_SUBTLE_SUBLET_BATCH), 0L, 0x1fffffffL, True,
+      subEwmhGet(SUB_EWMH_UTF8), &rtype, &format, &nitems,
+      &bytes, &data) && data)
+    {
+      char *rec = (char *)data, *end = (char *)data + nitems, *str = NULL;
+      SubPanel *p = NULL;
+
+      /* Records are pairs of id and data, each terminated by nul */
+      while(rec < end && (str = memchr(rec, '\0', end - rec)) &&
+          ++str < end && memchr(str, '\0', end - str))
+        {
+          if((p = EventFindSublet(atoi(rec))) &&
+              p->sublet->flags & SUB_SUBLET_DATA)
+            {
+              subRubyCall(SUB_CALL_DATA, p->sublet->instance, str);
+              updated++;
+            }
+
+          rec = str + strlen(str) + 1;
+        }
+
+      XFree(data);
+    }
+
+  subSharedLogDebugEvents("Batch: nitems=%lu, updated=%d\n", nitems, updated);
+
+  if(updated) EventRender(); ///< Render once for all sublets
+} /* }}} */
+
 /* EventQueuePush {{{ */
 static void
 EventQueuePush(XClientMessageEvent *ev,
@@ -133,55 +244,6 @@ EventQueuePop(long value,
     }
 } /* }}} */
 
-/* EventMatch {{{ */
-static int
-EventMatch(int type,
-  XRectangle *origin,
-  XRectangle *test)
-{
-  int cx_origin = 0, cx_test = 0, cy_origin = 0, cy_test = 0, dx = 0, dy = 0;
-
-  /* This check is complicated and consists of three parts:
-   * 1) Calculate window center positions
-   * 2) Check if x/y values decrease in given direction
-   * 3) Check if a corner of one of the rects is close enough to
-   *    a side of the other rect */
-
-  /* Calculate window centers */
-  cx_origin = origin->x + (origin->width / 2);
-  cx_test   = test->x + (test->width / 2);
-
-  cy_origin = origin->y + (origin->height / 2);
-  cy_test   = test->y + (test->height / 2);
-
-  /* Check geometries */
-  if((((SUB_GRAB_DIRECTION_LEFT  == type      && cx_test   <= cx_origin)                  ||
-       (SUB_GRAB_DIRECTION_RIGHT == type      && cx_test   >= cx_origin))                 &&
-       ((cy_test                 >= origin->y && cy_test   <= origin->y + origin->height) ||
-       (cy_origin                >= test->y   && cy_origin <= test->y   + test->height))) ||
-
-     (((SUB_GRAB_DIRECTION_UP    == type      && cy_test   <= cy_origin)                  ||
-       (SUB_GRAB_DIRECTION_DOWN  == type      && cy_test   >= cy_origin))                 &&
-       ((cx_test                 >= origin->x && cx_test   <= origin->x + origin->width)  ||
-       (cx_origin                 >= test->x   && cx_origin <= test->x   + test->width))))
-    {
-      /* Euclidean distance */
-      dx = abs(cx_origin - cx_test);
-      dy = abs(cy_origin - cy_test);
-
-      /* Zero distance means same dimensions - highest distance */
-      if(0 == dx && 0 == dy) dx = dy = 1L << 15;
-    }
-  else
-    {
-      /* No match - highest distance too */
-      dx = 1L << 15;
-      dy = 1L << 15;
-    }
-
-  return dx + dy;
-} /* }}} */
-
 /* Events */
 
 /* EventColormap {{{ */
@@ -210,7 +272,10 @@ EventConfigure(XConfigureEvent *ev)
 #ifdef HAVE_X11_EXTENSIONS_XRANDR_H
       /* Update RandR config */
       if(subtle->flags & SUB_SUBTLE_XRANDR)
-        XRRUpdateConfiguration((XEvent *)ev);
+        {
+          XRRUpdateConfiguration((XEvent *)ev);
+          subScreenRate(); ///< Mode may change without resize
+        }
 #endif /* HAVE_X11_EXTENSIONS_XRANDR_H */
 
       /* Fetch screen geometry after update */
@@ -348,8 +413,8 @@ EventDestroy(XDestroyWindowEvent *ev)
 
       /* Kill client */
       subArrayRemove(subtle->clients, (void *)c);
+      subClientPublish(c, False);
       subClientKill(c);
-      subClientPublish(False);
 
       subScreenConfigure();
       subScreenUpdate();
@@ -701,7 +766,7 @@ EventGrab(XEvent *ev)
                         k->flags & SUB_CLIENT_MODE_STICK))
                       {
                         /* Substract stack position index to get top window */
-                        distance = EventMatch(g->data.num, &c->geom,
+                        distance = subEventMatch(g->data.num, &c->geom,
                           &k->geom) - i;
 
                         /* Substract history stack position index */
@@ -895,6 +960,7 @@ EventMapRequest(XMapRequestEvent *ev)
   else if((c = subClientNew(ev->window)))
     {
       subArrayPush(subtle->clients, (void *)c);
+      subClientPublish(c, True);
       subClientRestack(c, SUB_CLIENT_RESTACK_UP);
 
       subScreenConfigure();
@@ -1152,10 +1218,12 @@ EventMessage(XClientMessageEvent *ev)
                 p->sublet->flags & SUB_SUBLET_DATA)
               {
                 subRubyCall(SUB_CALL_DATA, p->sublet->instance, NULL);
-                subScreenUpdate();
-                subScreenRender();
+                EventRender();
               }
             break; /* }}} */
+          case SUB_EWMH_SUBTLE_SUBLET_BATCH: /* {{{ */
+            EventSubletBatch();
+            break; /* }}} */
           case SUB_EWMH_SUBTLE_SUBLET_STYLE: /* {{{ */
             if(ev->data.b)
               {
@@ -1200,8 +1268,7 @@ EventMessage(XClientMessageEvent *ev)
             if((p = EventFindSublet((int)ev->data.l[0])))
               {
                 subRubyCall(SUB_CALL_RUN, p->sublet->instance, NULL);
-                subScreenUpdate();
-                subScreenRender();
+                EventRender();
               }
             break; /* }}} */
           case SUB_EWMH_SUBTLE_SUBLET_KILL: /* {{{ */
@@ -1626,8 +1693,8 @@ EventUnmap(XUnmapEvent *ev)
       XSelectInput(subtle->dpy, c->win, NoEventMask);
 
       subArrayRemove(subtle->clients, (void *)c);
+      subClientPublish(c, False);
       subClientKill(c);
-      subClientPublish(False);
 
       subScreenUpdate();
       subScreenRender();
@@ -1668,6 +1735,134 @@ EventUnmap(XUnmapEvent *ev)
 
 /* Public */
 
+ /** subEventMatch {{{
+  * @brief Get distance of two rects in given direction
+  * @param[in]  type    Direction
+  * @param[in]  origin  Origin rect
+  * @param[in]  test    Rect to test
+  * @return Returns the distance or \p 1 << 16 when there is no match
+  **/
+
+int
+subEventMatch(int type,
+  XRectangle *origin,
+  XRectangle *test)
+{
+  int cx_origin = 0, cx_test = 0, cy_origin = 0, cy_test = 0, dx = 0, dy = 0;
+
+  /* This check is complicated and consists of three parts:
+   * 1) Calculate window center positions
+   * 2) Check if x/y values decrease in given direction
+   * 3) Check if a corner of one of the rects is close enough to
+   *    a side of the other rect */
+
+  /* Calculate window centers */
+  cx_origin = origin->x + (origin->width / 2);
+  cx_test   = test->x + (test->width / 2);
+
+  cy_origin = origin->y + (origin->height / 2);
+  cy_test   = test->y + (test->height / 2);
+
+  /* Check geometries */
+  if((((SUB_GRAB_DIRECTION_LEFT  == type      && cx_test   <= cx_origin)                  ||
+       (SUB_GRAB_DIRECTION_RIGHT == type      && cx_test   >= cx_origin))                 &&
+       ((cy_test                 >= origin->y && cy_test   <= origin->y + origin->height) ||
+       (cy_origin                >= test->y   && cy_origin <= test->y   + test->height))) ||
+
+     (((SUB_GRAB_DIRECTION_UP    == type      && cy_test   <= cy_origin)                  ||
+       (SUB_GRAB_DIRECTION_DOWN  == type      && cy_test   >= cy_origin))                 &&
+       ((cx_test                 >= origin->x && cx_test   <= origin->x + origin->width)  ||
+       (cx_origin                 >= test->x   && cx_origin <= test->x   + test->width))))
+    {
+      /* Euclidean distance */
+      dx = abs(cx_origin - cx_test);
+      dy = abs(cy_origin - cy_test);
+
+      /* Zero distance means same dimensions - highest distance */
+      if(0 == dx && 0 == dy) dx = dy = 1L << 15;
+    }
+  else
+    {
+      /* No match - highest distance too */
+      dx = 1L << 15;
+      dy = 1L << 15;
+    }
+
+  return dx + dy;
+} /* }}} */
+
+ /** subEventCoalesce {{{
+  * @brief Drop events of a burst that are superseded by later ones
+  * @param[inout]  events   Event burst
+  * @param[in]     nevents  Number of events
+  * @return Returns the number of dropped events
+  **/
+
+int
+subEventCoalesce(XEvent *events,
+  int nevents)
+{
+  int i, j, dropped = 0;
+
+  /* Fold superseded events into the latest one of same window */
+  for(i = 0; i < nevents; i++)
+    {
+      if(ConfigureRequest != events[i].type &&
+          PropertyNotify != events[i].type)
+        continue;
+
+      for(j = i + 1; j < nevents; j++)
+        {
+          if(events[j].type != events[i].type) continue;
+
+          if(ConfigureRequest == events[i].type)
+            {
+              XConfigureRequestEvent *older = &events[i].xconfigurerequest;
+              XConfigureRequestEvent *newer = &events[j].xconfigurerequest;
+              unsigned long mask = 0;
+
+              /* xany.window is the parent here, so compare the client */
+              if(newer->window != older->window) continue;
+
+              /* Keep values the newer request doesn't change */
+              mask = older->value_mask & ~newer->value_mask;
+
+              if(mask & CWX)           newer->x            = older->x;
+              if(mask & CWY)           newer->y            = older->y;
+              if(mask & CWWidth)       newer->width        = older->width;
+              if(mask & CWHeight)      newer->height       = older->height;
+              if(mask & CWBorderWidth) newer->border_width = older->border_width;
+              if(mask & CWSibling)     newer->above        = older->above;
+              if(mask & CWStackMode)   newer->detail       = older->detail;
+
+              newer->value_mask |= older->value_mask;
+            }
+          else if(events[j].xproperty.window != events[i].xproperty.window ||
+              events[j].xproperty.atom != events[i].xproperty.atom)
+            continue;
+
+          /* Properties are re-read anyway */
+          events[i].type = 0; ///< Skip on dispatch
+          dropped++;
+
+          break;
+        }
+    }
+
+  return dropped;
+} /* }}} */
+
+ /** subEventMessage {{{
+  * @brief Handle client message like one sent via X
+  * @param[in]  ev  A #XClientMessageEvent
+  **/
+
+void
+subEventMessage(XClientMessageEvent *ev)
+{
+  EventMessage(ev);
+} /* }}} */
+
  /** subEventWatchAdd {{{
   * @brief Add descriptor to watch list
   * @param[in]  fd  File descriptor
@@ -1701,13 +1896,37 @@ subEventWatchDel(int fd)
         {
           for(j = i; j < nwatches - 1; j++)
             watches[j] = watches[j + 1];
+
+          nwatches--;
+          watches = (struct pollfd *)subSharedMemoryRealloc(watches,
+            nwatches * sizeof(struct pollfd));
+
           break;
         }
     }
+} /* }}} */
 
-  nwatches--;
-  watches = (struct pollfd *)subSharedMemoryRealloc(watches,
-    nwatches * sizeof(struct pollfd));
+ /** subEventWatchEvents {{{
+  * @brief Set polled events of watched fd
+  * @param[in]  fd      File descriptor
+  * @param[in]  events  Poll event mask
+  **/
+
+void
+subEventWatchEvents(int fd,
+  short events)
+{
+  int i;
+
+  for(i = 0; i < nwatches; i++)
+    {
+      if(watches[i].fd == fd)
+        {
+          watches[i].events = events;
+
+          break;
+        }
+    }
 } /* }}} */
 
  /** subEventLoop {{{
@@ -1718,7 +1937,8 @@ void
 subEventLoop(void)
 {
   int i, timeout = 1, nevents = 0;
-  XEvent ev;
+  unsigned long long start = 0;
+  XEvent events[BURSTLEN];
   time_t now;
   SubPanel *p = NULL;
 
@@ -1755,10 +1975,20 @@ subEventLoop(void)
     {
       now = subSubtleTime();
 
+      /* Check if tracing was toggled */
+      if(subtle->flags & SUB_SUBTLE_TRACE)
+        {
+          subtle->flags &= ~SUB_SUBTLE_TRACE;
+          subTraceToggle();
+        }
+
       /* Check if we need to reload */
       if(subtle->flags & SUB_SUBTLE_RELOAD)
         {
           int tray = subtle->flags & SUB_SUBTLE_TRAY;
+          SubAccount mark;
+
+          subDisplayMark(&mark);
 
           subtle->flags &= ~SUB_SUBTLE_RELOAD;
           subRubyReloadConfig();
@@ -1768,10 +1998,23 @@ subEventLoop(void)
             subTrayDeselect();
           else if(!tray && subtle->flags & SUB_SUBTLE_TRAY)
             subTraySelect();
+
+          subDisplayAccount(SUB_ACCOUNT_RELOAD, &mark);
         }
 
+      /* Collect garbage before blocking */
+      subRubyCollect();
+
+      /* Send all requests of this iteration at once */
+      XFlush(subtle->dpy);
+
       /* Data ready on any connection */
-      if(0 < (nevents = poll(watches, nwatches, timeout * 1000)))
+      start   = subTraceStart();
+      nevents = poll(watches, nwatches, timeout * 1000);
+
+      subTraceSpan("loop", "poll", NULL, start);
+
+      if(0 < nevents)
         {
           for(i = 0; i < nwatches; i++) ///< Find descriptor
             {
@@ -1779,30 +2022,73 @@ subEventLoop(void)
                 {
                   if(watches[i].fd == ConnectionNumber(subtle->dpy)) ///< X events {{{
                     {
+                      subRubyDefer(True); ///< No GC during event burst
+
                       while(XPending(subtle->dpy)) ///< X events
                         {
-                          XNextEvent(subtle->dpy, &ev);
-                          switch(ev.type)
+                          int j, nburst = 0, dropped = 0;
+
+                          /* Fetch queued events and drop superseded ones;
+                           * grabs end a burst since drags read the queue */
+                          do XNextEvent(subtle->dpy, &events[nburst++]);
+                          while(nburst < BURSTLEN && XQLength(subtle->dpy) &&
+                            ButtonPress != events[nburst - 1].type &&
+                            KeyPress != events[nburst - 1].type);
+
+                          if(1 < nburst &&
+                              0 < (dropped = subEventCoalesce(events, nburst)))
+                            subSharedLogDebugEvents("Coalesce: nburst=%d, dropped=%d\n",
+                              nburst, dropped);
+
+                          for(j = 0; j < nburst; j++)
                             {
-                              case ColormapNotify:    EventColormap(&ev.xcolormap);                 break;
-                              case ConfigureNotify:   EventConfigure(&ev.xconfigure);               break;
-                              case ConfigureRequest:  EventConfigureRequest(&ev.xconfigurerequest); break;
-                              case EnterNotify:
-                              case LeaveNotify:       EventCrossing(&ev.xcrossing);                 break;
-                              case DestroyNotify:     EventDestroy(&ev.xdestroywindow);             break;
-                              case Expose:            EventExpose(&ev.xexpose);                     break;
-                              case FocusIn:           EventFocus(&ev.xfocus);                       break;
-                              case ButtonPress:
-                              case KeyPress:          EventGrab(&ev);                               break;
-                              case MapNotify:         EventMap(&ev.xmap);                           break;
-                              case MapRequest:        EventMapRequest(&ev.xmaprequest);             break;
-                              case ClientMessage:     EventMessage(&ev.xclient);                    break;
-                              case PropertyNotify:    EventProperty(&ev.xproperty);                 break;
-                              case SelectionClear:    EventSelection(&ev.xselectionclear);          break;
-                              case UnmapNotify:       EventUnmap(&ev.xunmap);                       break;
-                              default: break;
+                              XEvent *ev = &events[j];
+                              unsigned long syncs = subtle->syncs;
+                              SubAccountId id;
+                              SubAccount mark;
+                              unsigned long long dispatched = 0;
+
+                              if(0 == ev->type) continue; ///< Coalesced
+
+                              subDisplayMark(&mark);
+                              start      = subTraceStart();
+                              dispatched = subSubtleClock(CLOCK_MONOTONIC);
+
+                              switch(ev->type)
+                                {
+                                  case ColormapNotify:    EventColormap(&ev->xcolormap);                 break;
+                                  case ConfigureNotify:   EventConfigure(&ev->xconfigure);               break;
+                                  case ConfigureRequest:  EventConfigureRequest(&ev->xconfigurerequest); break;
+                                  case EnterNotify:
+                                  case LeaveNotify:       EventCrossing(&ev->xcrossing);                 break;
+                                  case DestroyNotify:     EventDestroy(&ev->xdestroywindow);             break;
+                                  case Expose:            EventExpose(&ev->xexpose);                     break;
+                                  case FocusIn:           EventFocus(&ev->xfocus);                       break;
+                                  case ButtonPress:
+                                  case KeyPress:          EventGrab(ev);                                 break;
+                                  case MapNotify:         EventMap(&ev->xmap);                           break;
+                                  case MapRequest:        EventMapRequest(&ev->xmaprequest);             break;
+                                  case ClientMessage:     EventMessage(&ev->xclient);                    break;
+                                  case PropertyNotify:    EventProperty(&ev->xproperty);                 break;
+                                  case SelectionClear:    EventSelection(&ev->xselectionclear);          break;
+                                  case UnmapNotify:       EventUnmap(&ev->xunmap);                       break;
+                                  default: break;
+                                }
+
+                              if(SUB_ACCOUNT_TOTAL != (id = EventAccount(ev->type)))
+                                subDisplayAccount(id, &mark);
+
+                              subLatencyRecord(ev, dispatched);
+                              subTraceSpan("event", EventName(ev->type), NULL, start);
+
+                              /* Round trips should stay rare */
+                              if(syncs != subtle->syncs)
+                                subSharedLogDebugEvents("Sync: type=%d, syncs=%lu\n",
+                                  ev->type, subtle->syncs - syncs);
                             }
                         }
+
+                      subRubyDefer(False);
                     } /* }}} */
 #ifdef HAVE_SYS_INOTIFY_H
                   else if(watches[i].fd == subtle->notify) ///< Inotify {{{
@@ -1815,12 +2101,12 @@ subEventLoop(void)
                           if(event && IN_IGNORED != event->mask)
                             {
                               if((p = PANEL(subSubtleFind(
-                                  subtle->windows.support, event->wd))))
+                                  subtle->windows.support, event->wd))) &&
+                                  !(p->sublet->flags & SUB_SUBLET_SUSPEND))
                                 {
                                   subRubyCall(SUB_CALL_WATCH,
                                     p->sublet->instance, NULL);
-                                  subScreenUpdate();
-                                  subScreenRender();
+                                  EventRender();
                                 }
                             }
                         }
@@ -1831,11 +2117,16 @@ subEventLoop(void)
                       if((p = PANEL(subSubtleFind(subtle->windows.support,
                           watches[i].fd))))
                         {
-                          subRubyCall(SUB_CALL_WATCH,
+                          /* Sublet helper or socket watch */
+                          if(p->sublet->flags & SUB_SUBLET_FORK &&
+                              p->sublet->helper == watches[i].fd)
+                            subRubyHelperReceive(p);
+                          else subRubyCall(SUB_CALL_WATCH,
                             p->sublet->instance, NULL);
-                          subScreenUpdate();
-                          subScreenRender();
+
+                          EventRender();
                         }
+                      else subControlHandle(watches[i].fd); ///< Control socket
                     } /* }}} */
                 }
             }
@@ -1850,7 +2141,8 @@ subEventLoop(void)
               while(p && p->sublet->flags & SUB_SUBLET_INTERVAL &&
                   p->sublet->time <= now)
                 {
-                  subRubyCall(SUB_CALL_RUN, p->sublet->instance, NULL);
+                  if(!(p->sublet->flags & SUB_SUBLET_SUSPEND))
+                    subRubyCall(SUB_CALL_RUN, p->sublet->instance, NULL);
 
                   /* This may change during run */
                   if(p->sublet->flags & SUB_SUBLET_INTERVAL) 
@@ -1862,10 +2154,73 @@ subEventLoop(void)
                   subArraySort(subtle->sublets, subPanelCompare);
                 }
 
+              EventRender();
+            }
+        } /* }}} */
+
+      /* Kill stuck sublet helpers */
+      for(i = 0; i < subtle->sublets->ndata; i++)
+        {
+          p = PANEL(subtle->sublets->data[i]);
+
+          if(p->sublet->flags & SUB_SUBLET_BUSY &&
+              p->sublet->deadline <= subSubtleClock(CLOCK_MONOTONIC))
+            {
+              subSharedLogWarn("Killing stuck helper of sublet `%s'\n",
+                p->sublet->name);
+
+              subRubyHelperKill(p, True);
+            }
+        }
+
+      /* Suspend hidden sublets and catch up when shown again */
+      for(i = 0; i < subtle->sublets->ndata; i++)
+        {
+          p = PANEL(subtle->sublets->data[i]);
+
+          if(p->flags & SUB_PANEL_HIDDEN &&
+              !(p->sublet->flags & SUB_SUBLET_SUSPEND))
+            {
+              p->sublet->flags |= SUB_SUBLET_SUSPEND;
+
+              if(p->sublet->flags & SUB_SUBLET_SOCKET)
+                subEventWatchDel(p->sublet->watch);
+            }
+          else if(!(p->flags & SUB_PANEL_HIDDEN) &&
+              p->sublet->flags & SUB_SUBLET_SUSPEND)
+            {
+              p->sublet->flags &= ~SUB_SUBLET_SUSPEND;
+
+              /* Running helpers poll their socket watch themselves */
+              if(p->sublet->flags & SUB_SUBLET_SOCKET && 0 == p->sublet->pid)
+                subEventWatchAdd(p->sublet->watch);
+
+              if(p->sublet->flags & SUB_SUBLET_RUN)
+                {
+                  subRubyCall(SUB_CALL_RUN, p->sublet->instance, NULL);
+                  EventRender();
+                }
+            }
+        }
+
+      /* Unload hung sublets */
+      for(i = 0; i < subtle->sublets->ndata; i++)
+        {
+          p = PANEL(subtle->sublets->data[i]);
+
+          if(p->sublet->flags & SUB_SUBLET_HUNG)
+            {
+              subRubyUnloadSublet(p);
               subScreenUpdate();
               subScreenRender();
+              i--; ///< Prevent skipping of entries
             }
-        } /* }}} */
+        }
+
+      subPanelProfilePublish();
+      subDisplayAccountPublish();
+      subLatencyPublish();
+      subClientPublishStacking();
 
       /* Set new timeout */
       if(0 < subtle->sublets->ndata)
@@ -1874,6 +2229,23 @@ subEventLoop(void)
 
           timeout = p->sublet->flags & SUB_SUBLET_INTERVAL ?
             p->sublet->time - now : 60;
+
+          /* Wake up for helper deadlines */
+          for(i = 0; i < subtle->sublets->ndata; i++)
+            {
+              unsigned long long clock = subSubtleClock(CLOCK_MONOTONIC);
+
+              p = PANEL(subtle->sublets->data[i]);
+
+              if(p->sublet->flags & SUB_SUBLET_BUSY)
+                {
+                  int left = p->sublet->deadline > clock ?
+                    (int)((p->sublet->deadline - clock) / 1000000ULL) + 1 : 1;
+
+                  timeout = MIN(timeout, left);
+                }
+            }
+
           if(0 >= timeout) timeout = 1; ///< Sanitize
         }
       else timeout = 60;
@@ -80,35 +80,57 @@ subGrabNew(const char *keys,
 {
   int mouse = False;
   unsigned int code = 0, state = 0;
-  KeySym sym = NoSymbol;
   SubGrab *g = NULL;
 
   assert(keys);
 
   /* Parse keys */
-  if(NoSymbol != (sym = subSharedParseKey(subtle->dpy,
-      keys, &code, &state, &mouse)))
+  if(NoSymbol != subSharedParseKey(subtle->dpy, keys, &code, &state, &mouse))
     {
-      /* Find or create new grab */
-      if(!(g = subGrabFind(code, state)))
-        {
-          g = GRAB(subSharedMemoryAlloc(1, sizeof(SubGrab)));
-          g->code  = code;
-          g->state = state;
-          g->flags = SUB_TYPE_GRAB|(mouse ? SUB_GRAB_MOUSE : SUB_GRAB_KEY);
-
-          if(duplicate) *duplicate = False;
-        }
-      else if(duplicate) *duplicate = True;
+      g = subGrabNewCode(code, state, mouse, duplicate);
 
-      subSharedLogDebugSubtle("new=grab, type=%s, keys=%s, code=%03d, state=%02d\n",
-        g->flags & SUB_GRAB_KEY ? "key" : "mouse", keys, g->code, g->state);
+      subSharedLogDebugSubtle("new=grab, keys=%s\n", keys);
     }
   else subSharedLogWarn("Failed assigning grab `%s'\n", keys);
 
   return g;
 } /* }}} */
 
+ /** subGrabNewCode {{{
+  * @brief Create new grab from parsed keys
+  * @param[in]   code       Key code
+  * @param[in]   state      Key state
+  * @param[in]   mouse      Whether this is mouse press
+  * @param[out]  duplicate  Added twice
+  * @return Returns a #SubGrab
+  **/
+
+SubGrab *
+subGrabNewCode(unsigned int code,
+  unsigned int state,
+  int mouse,
+  int *duplicate)
+{
+  SubGrab *g = NULL;
+
+  /* Find or create new grab */
+  if(!(g = subGrabFind(code, state)))
+    {
+      g = GRAB(subSharedMemoryAlloc(1, sizeof(SubGrab)));
+      g->code  = code;
+      g->state = state;
+      g->flags = SUB_TYPE_GRAB|(mouse ? SUB_GRAB_MOUSE : SUB_GRAB_KEY);
+
+      if(duplicate) *duplicate = False;
+    }
+  else if(duplicate) *duplicate = True;
+
+  subSharedLogDebugSubtle("new=grab, type=%s, code=%03d, state=%02d\n",
+    g->flags & SUB_GRAB_KEY ? "key" : "mouse", g->code, g->state);
+
+  return g;
+} /* }}} */
+
  /** subGrabFind {{{
   * @brief Find grab
   * @param[in]  code   A key code
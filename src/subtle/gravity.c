@@ -167,7 +167,5 @@ subGravityPublish(void)
   subSharedLogDebugSubtle("publish=gravities, n=%d\n",
     subtle->gravities->ndata);
 
-  XSync(subtle->dpy, False); ///< Sync all changes
-
   free(gravities);
 } /* }}} */
@@ -47,7 +47,7 @@ void
 subHookCall(int type,
   void *data)
 {
-  int i;
+  int i, synced = False;
 
   /* Call matching hooks */
   for(i = 0; i < subtle->hooks->ndata; i++)
@@ -56,7 +56,14 @@ subHookCall(int type,
 
       if((h->flags & ~SUB_TYPE_HOOK) == type)
         {
-          subRubyCall(SUB_CALL_HOOKS, h->proc, data);
+          /* Hooks query state via subtlext's own connection */
+          if(!synced)
+            {
+              subSubtleSync();
+              synced = True;
+            }
+
+          subRubyCall(SUB_CALL_EMIT, (unsigned long)h, data);
 
           subSharedLogDebug("call=hook, type=%d, proc=%ld, data=%p\n",
             type, h->proc, data);
@@ -0,0 +1,247 @@
+
+ /**
+  * @package subtle
+  *
+  * @file Latency functions
+  * @copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  **/
+
+#include "subtle.h"
+
+/* Macros */
+#define LATENCY_SUB      8                                        ///< Buckets per power of two
+#define LATENCY_BUCKETS  (21 * LATENCY_SUB)                       ///< Buckets up to ~8s in usec
+#define LATENCY_FIELDS   6                                        ///< Published values per histogram
+
+#define LATENCY_DISPATCH 0                                        ///< Dispatch time by event type
+#define LATENCY_MESSAGE  1                                        ///< Dispatch time by message type
+#define LATENCY_PROPERTY 2                                        ///< Dispatch time by property
+#define LATENCY_AGE      3                                        ///< Age of input events
+
+/* Typedefs */
+typedef struct latencyhistogram_t /* {{{ */
+{
+  unsigned long count, max;                                       ///< Histogram count and max value
+  unsigned int  buckets[LATENCY_BUCKETS];                         ///< Histogram buckets
+} LatencyHistogram; /* }}} */
+
+/* Globals */
+static LatencyHistogram *dispatch[LASTEvent] = { NULL }, *age[LASTEvent] = { NULL };
+static LatencyHistogram *messages[SUB_EWMH_TOTAL + 1] = { NULL };
+static LatencyHistogram *properties[SUB_EWMH_TOTAL + 1] = { NULL };
+static unsigned int offset = 0;
+static int calibrated = False, dirty = False;
+static time_t published = 0;
+
+/* LatencyBucket {{{ */
+static int
+LatencyBucket(unsigned long value)
+{
+  int msb = 0;
+
+  /* Small values get exact buckets */
+  if(LATENCY_SUB > value) return value;
+
+  /* Log-linear buckets: fixed number of sub buckets per power of two */
+  msb = 8 * sizeof(unsigned long) - 1 - __builtin_clzl(value);
+
+  return MIN((msb - 3) * LATENCY_SUB + (value >> (msb - 3)),
+    LATENCY_BUCKETS - 1);
+} /* }}} */
+
+/* LatencyValue {{{ */
+static unsigned long
+LatencyValue(int bucket)
+{
+  int shift = bucket / LATENCY_SUB - 1;
+
+  if(2 * LATENCY_SUB > bucket) return bucket;
+
+  /* Upper end of bucket */
+  return ((unsigned long)(bucket - shift * LATENCY_SUB + 1) << shift) - 1;
+} /* }}} */
+
+/* LatencyRecord {{{ */
+static void
+LatencyRecord(LatencyHistogram **h,
+  unsigned long value)
+{
+  if(!*h) *h = (LatencyHistogram *)subSharedMemoryAlloc(1,
+    sizeof(LatencyHistogram));
+
+  (*h)->buckets[LatencyBucket(value)]++;
+  (*h)->count++;
+  (*h)->max = MAX((*h)->max, value);
+
+  dirty = True;
+} /* }}} */
+
+/* LatencyPercentile {{{ */
+static unsigned long
+LatencyPercentile(LatencyHistogram *h,
+  int percent)
+{
+  int i;
+  unsigned long sum = 0, rank = (h->count * percent + 99) / 100;
+
+  for(i = 0; i < LATENCY_BUCKETS; i++)
+    if((sum += h->buckets[i]) >= rank) break;
+
+  return MIN(LatencyValue(i), h->max);
+} /* }}} */
+
+/* LatencyAge {{{ */
+static void
+LatencyAge(int type,
+  Time time,
+  unsigned long long now)
+{
+  int diff = 0;
+  unsigned int local = (unsigned int)(now / 1000);
+
+  /* Server time is in msec since server start; the offset to our clock
+   * is taken from the freshest event seen so far */
+  diff = (int)(local - (unsigned int)time - offset);
+
+  if(!calibrated || 0 > diff)
+    {
+      offset     = local - (unsigned int)time;
+      calibrated = True;
+      diff       = 0;
+    }
+
+  LatencyRecord(&age[type], (unsigned long)diff * 1000);
+} /* }}} */
+
+/* LatencyAdd {{{ */
+static int
+LatencyAdd(long *stats,
+  int idx,
+  int kind,
+  long id,
+  LatencyHistogram *h)
+{
+  long *v = &stats[idx * LATENCY_FIELDS];
+
+  if(!h) return idx;
+
+  v[0] = kind;
+  v[1] = id;
+  v[2] = h->count;
+  v[3] = LatencyPercentile(h, 50);
+  v[4] = LatencyPercentile(h, 99);
+  v[5] = h->max;
+
+  return idx + 1;
+} /* }}} */
+
+ /** subLatencyRecord {{{
+  * @brief Record dispatch latency and age of an event
+  * @param[in]  ev     A #XEvent
+  * @param[in]  start  Dispatch start in usec
+  **/
+
+void
+subLatencyRecord(XEvent *ev,
+  unsigned long long start)
+{
+  unsigned long long now = subSubtleClock(CLOCK_MONOTONIC);
+
+  assert(ev);
+
+  if(0 > ev->type || LASTEvent <= ev->type) return; ///< Skip extension events
+
+  switch(ev->type)
+    {
+      case ClientMessage:
+        LatencyRecord(&messages[subEwmhFind(ev->xclient.message_type) + 1],
+          now - start);
+        break;
+      case PropertyNotify:
+        LatencyRecord(&properties[subEwmhFind(ev->xproperty.atom) + 1],
+          now - start);
+        break;
+      case ButtonPress:
+        LatencyAge(ev->type, ev->xbutton.time, start);
+        LatencyRecord(&dispatch[ev->type], now - start);
+        break;
+      case KeyPress:
+        LatencyAge(ev->type, ev->xkey.time, start);
+        LatencyRecord(&dispatch[ev->type], now - start);
+        break;
+      default:
+        LatencyRecord(&dispatch[ev->type], now - start);
+    }
+} /* }}} */
+
+ /** subLatencyPublish {{{
+  * @brief Publish latency stats at most once per second
+  **/
+
+void
+subLatencyPublish(void)
+{
+  int i, idx = 0;
+  long *stats = NULL;
+  time_t now = 0;
+
+  /* Check for changes and throttle */
+  if(!dirty || (now = subSubtleTime()) == published) return;
+
+  stats = (long *)subSharedMemoryAlloc((2 * LASTEvent +
+    2 * (SUB_EWMH_TOTAL + 1)) * LATENCY_FIELDS, sizeof(long));
+
+  /* Collect used histograms, messages and properties by atom */
+  for(i = 0; i < LASTEvent; i++)
+    {
+      idx = LatencyAdd(stats, idx, LATENCY_DISPATCH, i, dispatch[i]);
+      idx = LatencyAdd(stats, idx, LATENCY_AGE,      i, age[i]);
+    }
+
+  for(i = 0; i <= SUB_EWMH_TOTAL; i++)
+    {
+      Atom atom = 0 < i ? subEwmhGet(i - 1) : None;
+
+      idx = LatencyAdd(stats, idx, LATENCY_MESSAGE,  atom, messages[i]);
+      idx = LatencyAdd(stats, idx, LATENCY_PROPERTY, atom, properties[i]);
+    }
+
+  /* EWMH: Latency stats */
+  subEwmhSetCardinals(ROOT, SUB_EWMH_SUBTLE_LATENCY_STATS, stats,
+    idx * LATENCY_FIELDS);
+
+  free(stats);
+
+  dirty     = False;
+  published = now;
+} /* }}} */
+
+ /** subLatencyFinish {{{
+  * @brief Free histograms
+  **/
+
+void
+subLatencyFinish(void)
+{
+  int i;
+
+  for(i = 0; i < LASTEvent; i++)
+    {
+      if(dispatch[i]) free(dispatch[i]);
+      if(age[i])      free(age[i]);
+    }
+
+  for(i = 0; i <= SUB_EWMH_TOTAL; i++)
+    {
+      if(messages[i])   free(messages[i]);
+      if(properties[i]) free(properties[i]);
+    }
+
+  subSharedLogDebugSubtle("finish=latency\n");
+} /* }}} */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker
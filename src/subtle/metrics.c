@@ -0,0 +1,227 @@
+
+ /**
+  * @package subtle
+  *
+  * @file Metrics functions
+  * @copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  **/
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <dirent.h>
+#include "subtle.h"
+
+/* Globals */
+static SubMetrics metrics = { { 0 }, { 0 }, { 0 }, { -1, 0 } };
+static time_t stamps[4] = { 0 };
+static char buffer[8192] = { 0 }, battery[NAME_MAX + 1] = { 0 };
+
+/* MetricsRead {{{ */
+static int
+MetricsRead(const char *file)
+{
+  int fd = -1;
+  ssize_t n = -1;
+
+  /* Read file at once into shared buffer */
+  if(-1 != (fd = open(file, O_RDONLY)))
+    {
+      if(0 <= (n = read(fd, buffer, sizeof(buffer) - 1))) buffer[n] = '\0';
+
+      close(fd);
+    }
+
+  return (int)n;
+} /* }}} */
+
+/* MetricsValue {{{ */
+static unsigned long
+MetricsValue(const char *key)
+{
+  char *pos = NULL;
+
+  /* Find value of key in buffer */
+  if((pos = strstr(buffer, key)))
+    return strtoul(pos + strlen(key), NULL, 10);
+
+  return 0;
+} /* }}} */
+
+/* MetricsCpu {{{ */
+static void
+MetricsCpu(void)
+{
+  unsigned long long user = 0, nice = 0, sys = 0, idle = 0;
+  unsigned long long iowait = 0, irq = 0, softirq = 0, total = 0;
+
+  /* First line contains the sum of all cpus */
+  if(0 >= MetricsRead("/proc/stat") ||
+      4 > sscanf(buffer, "cpu %llu %llu %llu %llu %llu %llu %llu",
+      &user, &nice, &sys, &idle, &iowait, &irq, &softirq))
+    return;
+
+  total = user + nice + sys + idle + iowait + irq + softirq;
+  idle += iowait;
+
+  if(metrics.cpu.total && total > metrics.cpu.total)
+    {
+      metrics.cpu.usage = 100 - (int)(100 * (idle - metrics.cpu.idle) /
+        (total - metrics.cpu.total));
+      metrics.cpu.usage = MINMAX(metrics.cpu.usage, 0, 100);
+    }
+
+  metrics.cpu.total = total;
+  metrics.cpu.idle  = idle;
+} /* }}} */
+
+/* MetricsMemory {{{ */
+static void
+MetricsMemory(void)
+{
+  unsigned long avail = 0;
+
+  if(0 >= MetricsRead("/proc/meminfo")) return;
+
+  metrics.memory.total   = MetricsValue("MemTotal:");
+  metrics.memory.free    = MetricsValue("MemFree:");
+  metrics.memory.buffers = MetricsValue("Buffers:");
+  metrics.memory.cached  = MetricsValue("\nCached:");
+
+  avail = metrics.memory.free + metrics.memory.buffers +
+    metrics.memory.cached;
+
+  metrics.memory.used = metrics.memory.total -
+    MIN(avail, metrics.memory.total);
+} /* }}} */
+
+/* MetricsNetwork {{{ */
+static void
+MetricsNetwork(time_t now)
+{
+  char *line = NULL;
+  time_t diff = 0;
+  unsigned long long rx = 0, tx = 0;
+
+  if(0 >= MetricsRead("/proc/net/dev")) return;
+
+  /* Sum up all interfaces except loopback */
+  for(line = strchr(buffer, '\n'); line; line = strchr(line + 1, '\n'))
+    {
+      char name[32] = { 0 };
+      unsigned long long r = 0, t = 0;
+
+      if(3 == sscanf(line + 1, " %31[^:]: %llu %*u %*u %*u %*u %*u %*u %*u "
+          "%llu", name, &r, &t) && 0 != strcmp(name, "lo"))
+        {
+          rx += r;
+          tx += t;
+        }
+    }
+
+  /* Calculate rates since last sample */
+  if(stamps[2] && (diff = now - stamps[2]) &&
+      rx >= metrics.network.rx && tx >= metrics.network.tx)
+    {
+      metrics.network.rxrate = (rx - metrics.network.rx) / diff;
+      metrics.network.txrate = (tx - metrics.network.tx) / diff;
+    }
+
+  metrics.network.rx = rx;
+  metrics.network.tx = tx;
+} /* }}} */
+
+/* MetricsBattery {{{ */
+static void
+MetricsBattery(void)
+{
+  char path[PATH_MAX] = { 0 };
+
+  /* Find first battery once */
+  if(!*battery)
+    {
+      DIR *dir = NULL;
+      struct dirent *entry = NULL;
+
+      if((dir = opendir("/sys/class/power_supply")))
+        {
+          while((entry = readdir(dir)))
+            {
+              if(0 == strncmp(entry->d_name, "BAT", 3))
+                {
+                  snprintf(battery, sizeof(battery), "%s", entry->d_name);
+
+                  break;
+                }
+            }
+
+          closedir(dir);
+        }
+
+      if(!*battery) return;
+    }
+
+  snprintf(path, sizeof(path), "/sys/class/power_supply/%s/capacity",
+    battery);
+
+  if(0 >= MetricsRead(path))
+    {
+      metrics.battery.capacity = -1;
+      *battery = '\0'; ///< Rescan on next sample
+
+      return;
+    }
+
+  metrics.battery.capacity = atoi(buffer);
+
+  snprintf(path, sizeof(path), "/sys/class/power_supply/%s/status",
+    battery);
+
+  metrics.battery.charging = (0 < MetricsRead(path) &&
+    0 == strncmp(buffer, "Charging", 8));
+} /* }}} */
+
+ /** subMetricsGet {{{
+  * @brief Get system metrics, every source is sampled at most once per second
+  * @param[in]  sources  Sources to sample
+  * @return Returns the shared #SubMetrics
+  **/
+
+SubMetrics *
+subMetricsGet(int sources)
+{
+  time_t now = subSubtleTime();
+
+  /* Sample outdated sources */
+  if(sources & SUB_METRICS_CPU && now != stamps[0])
+    {
+      MetricsCpu();
+      stamps[0] = now;
+    }
+
+  if(sources & SUB_METRICS_MEMORY && now != stamps[1])
+    {
+      MetricsMemory();
+      stamps[1] = now;
+    }
+
+  if(sources & SUB_METRICS_NETWORK && now != stamps[2])
+    {
+      MetricsNetwork(now);
+      stamps[2] = now;
+    }
+
+  if(sources & SUB_METRICS_BATTERY && now != stamps[3])
+    {
+      MetricsBattery();
+      stamps[3] = now;
+    }
+
+  return &metrics;
+} /* }}} */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker
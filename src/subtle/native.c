@@ -0,0 +1,321 @@
+
+ /**
+  * @package subtle
+  *
+  * @file Native sublet functions
+  * @copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  **/
+
+#include <unistd.h>
+#include <time.h>
+#include "subtle.h"
+
+#ifdef HAVE_DLFCN_H
+#include <dlfcn.h>
+#endif /* HAVE_DLFCN_H */
+
+/* Globals */
+#ifdef HAVE_DLFCN_H
+static void **plugins = NULL;
+static int nplugins = 0;
+#endif /* HAVE_DLFCN_H */
+
+/* Clock */
+
+/* NativeClockRun {{{ */
+static int
+NativeClockRun(void *data,
+  char *buf,
+  size_t len)
+{
+  time_t now = time(NULL);
+
+  return strftime(buf, len, "%H:%M", localtime(&now));
+} /* }}} */
+
+/* Cpu */
+
+/* NativeCpuRun {{{ */
+static int
+NativeCpuRun(void *data,
+  char *buf,
+  size_t len)
+{
+  SubMetrics *m = subMetricsGet(SUB_METRICS_CPU);
+
+  if(!m->cpu.total) return -1;
+
+  return snprintf(buf, len, "%d%%", m->cpu.usage);
+} /* }}} */
+
+/* Memory */
+
+/* NativeMemoryRun {{{ */
+static int
+NativeMemoryRun(void *data,
+  char *buf,
+  size_t len)
+{
+  SubMetrics *m = subMetricsGet(SUB_METRICS_MEMORY);
+
+  if(!m->memory.total) return -1;
+
+  return snprintf(buf, len, "%luM", m->memory.used / 1024);
+} /* }}} */
+
+/* Battery */
+
+/* NativeBatteryInit {{{ */
+static int
+NativeBatteryInit(void **data,
+  int *fd)
+{
+  return (0 <= subMetricsGet(SUB_METRICS_BATTERY)->battery.capacity);
+} /* }}} */
+
+/* NativeBatteryRun {{{ */
+static int
+NativeBatteryRun(void *data,
+  char *buf,
+  size_t len)
+{
+  SubMetrics *m = subMetricsGet(SUB_METRICS_BATTERY);
+
+  if(0 > m->battery.capacity) return -1;
+
+  return snprintf(buf, len, "%d%%%s", m->battery.capacity,
+    m->battery.charging ? "+" : "");
+} /* }}} */
+
+/* Network */
+
+/* NativeNetworkRun {{{ */
+static int
+NativeNetworkRun(void *data,
+  char *buf,
+  size_t len)
+{
+  SubMetrics *m = subMetricsGet(SUB_METRICS_NETWORK);
+
+  return snprintf(buf, len, "%luK/%luK", m->network.rxrate / 1024,
+    m->network.txrate / 1024);
+} /* }}} */
+
+/* Builtins {{{ */
+static SubNative natives[] =
+{
+  { SUB_NATIVE_ABI, "clock",   60, NULL, NativeClockRun, NULL, NULL },
+  { SUB_NATIVE_ABI, "cpu",     5,  NULL, NativeCpuRun, NULL, NULL },
+  { SUB_NATIVE_ABI, "memory",  10, NULL, NativeMemoryRun, NULL, NULL },
+  { SUB_NATIVE_ABI, "battery", 60, NativeBatteryInit, NativeBatteryRun,
+    NULL, NULL },
+  { SUB_NATIVE_ABI, "network", 5,  NULL, NativeNetworkRun, NULL, NULL }
+}; /* }}} */
+
+ /** subNativeFind {{{
+  * @brief Find builtin native sublet or load plugin
+  * @param[in]  name  Name of the native sublet
+  * @return Returns a #SubNative or \p NULL
+  **/
+
+SubNative *
+subNativeFind(const char *name)
+{
+  int i;
+
+  assert(name);
+
+  /* Check builtins */
+  for(i = 0; i < LENGTH(natives); i++)
+    if(0 == strcmp(natives[i].name, name)) return &natives[i];
+
+#ifdef HAVE_DLFCN_H
+  {
+    char buf[100] = { 0 }, *home = getenv("XDG_DATA_HOME"), path[50] = { 0 };
+    void *handle = NULL;
+    SubNative *n = NULL;
+
+    /* Combine paths */
+    snprintf(path, sizeof(path), "%s/.local/share", getenv("HOME"));
+    snprintf(buf, sizeof(buf), "%s/%s/plugins/%s.so",
+      home ? home : path, PKG_NAME, name);
+
+    /* Check plugins */
+    if(0 == access(buf, R_OK))
+      {
+        if(!(handle = dlopen(buf, RTLD_NOW|RTLD_LOCAL)))
+          {
+            subSharedLogWarn("Failed loading plugin `%s': %s\n",
+              buf, dlerror());
+
+            return NULL;
+          }
+
+        if(!(n = (SubNative *)dlsym(handle, SUB_NATIVE_SYMBOL)) ||
+            SUB_NATIVE_ABI != n->abi || !n->name)
+          {
+            subSharedLogWarn("Failed loading plugin `%s': Invalid ABI\n", buf);
+            dlclose(handle);
+
+            return NULL;
+          }
+
+        /* Keep plugin until exit */
+        for(i = 0; i < nplugins; i++)
+          {
+            if(plugins[i] == handle)
+              {
+                dlclose(handle); ///< Drop extra reference
+
+                return n;
+              }
+          }
+
+        plugins = (void **)subSharedMemoryRealloc(plugins,
+          (nplugins + 1) * sizeof(void *));
+        plugins[nplugins++] = handle;
+
+        subSharedLogDebug("Plugin: Loaded %s\n", buf);
+
+        return n;
+      }
+  }
+#endif /* HAVE_DLFCN_H */
+
+  return NULL;
+} /* }}} */
+
+ /** subNativeLoad {{{
+  * @brief Init native sublet
+  * @param[in]  p  A #SubPanel
+  * @retval  1  Success
+  * @retval  0  Failure
+  **/
+
+int
+subNativeLoad(SubPanel *p)
+{
+  int fd = -1;
+  SubNative *n = NULL;
+
+  assert(p && p->sublet->native);
+
+  n = p->sublet->native;
+
+  /* Call init */
+  if(n->init && !n->init(&p->sublet->data, &fd)) return False;
+
+  /* Add socket watch */
+  if(0 <= fd)
+    {
+      p->sublet->flags |= SUB_SUBLET_SOCKET;
+      p->sublet->watch  = fd;
+
+      XSaveContext(subtle->dpy, subtle->windows.support,
+        p->sublet->watch, (void *)p);
+      subEventWatchAdd(p->sublet->watch);
+    }
+
+  if(n->run)   p->sublet->flags |= SUB_SUBLET_RUN;
+  if(n->watch) p->sublet->flags |= SUB_SUBLET_WATCH;
+
+  p->sublet->buffer = (char *)subSharedMemoryAlloc(SUB_NATIVE_BUFLEN,
+    sizeof(char));
+
+  return True;
+} /* }}} */
+
+ /** subNativeCall {{{
+  * @brief Call native sublet
+  * @param[in]  type  Call type
+  * @param[in]  p     A #SubPanel
+  * @retval  1  Call was successful
+  * @retval  0  Call failed
+  **/
+
+int
+subNativeCall(int type,
+  SubPanel *p)
+{
+  int len = 0;
+  char buf[SUB_NATIVE_BUFLEN] = { 0 };
+  SubNative *n = NULL;
+
+  assert(p && p->sublet->native);
+
+  n = p->sublet->native;
+
+  /* Handle call type */
+  switch(type)
+    {
+      case SUB_CALL_RUN:
+        if(n->run) len = n->run(p->sublet->data, buf, sizeof(buf));
+        break;
+      case SUB_CALL_WATCH:
+        if(n->watch) len = n->watch(p->sublet->data, buf, sizeof(buf));
+        break;
+      default: return True;
+    }
+
+  /* Only parse changed text */
+  if(0 < len && 0 != strncmp(buf, p->sublet->buffer, SUB_NATIVE_BUFLEN))
+    {
+      buf[SUB_NATIVE_BUFLEN - 1] = '\0'; ///< Plugins may fill the buffer
+      memcpy(p->sublet->buffer, buf, SUB_NATIVE_BUFLEN);
+
+      subPanelParse(p, p->sublet->buffer);
+    }
+  else if(0 > len)
+    {
+      subSharedLogDebug("Native: Call of `%s' failed\n", p->sublet->name);
+
+      return False;
+    }
+
+  return True;
+} /* }}} */
+
+ /** subNativeKill {{{
+  * @brief Unload native sublet
+  * @param[in]  p  A #SubPanel
+  **/
+
+void
+subNativeKill(SubPanel *p)
+{
+  assert(p && p->sublet->native);
+
+  if(p->sublet->native->unload) p->sublet->native->unload(p->sublet->data);
+  if(p->sublet->buffer) free(p->sublet->buffer);
+
+  p->sublet->data   = NULL;
+  p->sublet->buffer = NULL;
+} /* }}} */
+
+ /** subNativeFinish {{{
+  * @brief Unload native plugins
+  **/
+
+void
+subNativeFinish(void)
+{
+#ifdef HAVE_DLFCN_H
+  int i;
+
+  for(i = 0; i < nplugins; i++)
+    dlclose(plugins[i]);
+
+  if(plugins) free(plugins);
+
+  plugins  = NULL;
+  nplugins = 0;
+#endif /* HAVE_DLFCN_H */
+
+  subSharedLogDebugSubtle("finish=native\n");
+} /* }}} */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker
@@ -0,0 +1,78 @@
+
+ /**
+  * @package subtle
+  *
+  * @file Native sublet header file
+  * @copyright Copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  **/
+
+#ifndef NATIVE_H
+#define NATIVE_H 1
+
+/* Includes {{{ */
+#include <stddef.h>
+/* }}} */
+
+/* Macros {{{ */
+#define SUB_NATIVE_ABI    1                                       ///< Native ABI version
+#define SUB_NATIVE_SYMBOL "subtle_native"                         ///< Native plugin symbol
+#define SUB_NATIVE_BUFLEN 256                                     ///< Native text buffer length
+/* }}} */
+
+/* Flags {{{ */
+#define SUB_METRICS_CPU     (1L << 0)                             ///< Sample cpu
+#define SUB_METRICS_MEMORY  (1L << 1)                             ///< Sample memory
+#define SUB_METRICS_NETWORK (1L << 2)                             ///< Sample network
+#define SUB_METRICS_BATTERY (1L << 3)                             ///< Sample battery
+/* }}} */
+
+/* Typedefs {{{ */
+typedef struct subnative_t /* {{{ */
+{
+  int        abi;                                                 ///< Native ABI version
+  const char *name;                                               ///< Native name
+  int        interval;                                            ///< Native default interval
+
+  int        (*init)(void **data, int *fd);                       ///< Native init, may set fd to watch
+  int        (*run)(void *data, char *buf, size_t len);           ///< Native run, returns text length
+  int        (*watch)(void *data, char *buf, size_t len);         ///< Native watch, returns text length
+  void       (*unload)(void *data);                               ///< Native unload
+} SubNative; /* }}} */
+
+typedef struct submetrics_t /* {{{ */
+{
+  struct
+  {
+    int                usage;                                     ///< Cpu usage in percent
+    unsigned long long total, idle;                               ///< Cpu total and idle jiffies
+  } cpu;
+
+  struct
+  {
+    unsigned long      total, free, buffers, cached, used;        ///< Memory values in KiB
+  } memory;
+
+  struct
+  {
+    unsigned long long rx, tx;                                    ///< Network bytes received, sent
+    unsigned long      rxrate, txrate;                            ///< Network rates in bytes/s
+  } network;
+
+  struct
+  {
+    int                capacity, charging;                        ///< Battery capacity (-1 if none), state
+  } battery;
+} SubMetrics; /* }}} */
+/* }}} */
+
+/* metrics.c {{{ */
+SubMetrics *subMetricsGet(int sources);                           ///< Get sampled metrics
+/* }}} */
+
+#endif /* NATIVE_H */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker
@@ -12,6 +12,15 @@
 
 #include "subtle.h"
 
+/* Macros {{{ */
+#define PROFILE_FIELDS 8                                          ///< Profile fields per sublet
+/* }}} */
+
+/* Globals {{{ */
+static int dirty = False;
+static time_t published = 0, logged = 0;
+/* }}} */
+
 /* PanelRect {{{ */
 static void
 PanelRect(Drawable drawable,
@@ -286,6 +295,29 @@ subPanelUpdate(SubPanel *p)
     }
 } /* }}} */
 
+ /** subPanelParse {{{
+  * @brief Parse sublet data and update width
+  * @param[in]  p     A #SubPanel
+  * @param[in]  data  Data string
+  **/
+
+void
+subPanelParse(SubPanel *p,
+  char *data)
+{
+  SubStyle *s = &subtle->styles.sublets, *style = NULL;
+
+  assert(p && data);
+
+  /* Select style */
+  if(s->styles && (style = subArrayGet(s->styles, p->sublet->style)))
+      s = style;
+
+  p->sublet->width = subSharedTextParse(subtle->dpy, subtle->font,
+    p->sublet->text, data) + STYLE_WIDTH((*s));
+  p->sublet->flags |= SUB_SUBLET_PARSED; ///< Blame next render
+} /* }}} */
+
  /** subPanelRender {{{
   * @brief Render panel
   * @param[in]  p         A #SubPanel
@@ -597,13 +629,158 @@ subPanelPublish(void)
   subSharedPropertySetStrings(subtle->dpy, ROOT,
     subEwmhGet(SUB_EWMH_SUBTLE_SUBLET_LIST), names, subtle->sublets->ndata);
 
-  subSharedLogDebugSubtle("publish=panel, n=%d\n", subtle->sublets->ndata);
+  dirty = True; ///< Order of sublet stats changed
 
-  XSync(subtle->dpy, False); ///< Sync all changes
+  subSharedLogDebugSubtle("publish=panel, n=%d\n", subtle->sublets->ndata);
 
   free(names);
 } /* }}} */
 
+ /** subPanelProfileCall {{{
+  * @brief Add call to sublet profile
+  * @param[in]  p       A #SubPanel
+  * @param[in]  cpu     Cpu time in usec
+  * @param[in]  wall    Wall time in usec
+  * @param[in]  allocs  Allocated objects
+  **/
+
+void
+subPanelProfileCall(SubPanel *p,
+  unsigned long cpu,
+  unsigned long wall,
+  unsigned long allocs)
+{
+  SubProfile *prof = NULL;
+
+  assert(p);
+
+  prof = &p->sublet->profile;
+
+  /* Update totals */
+  prof->cpu    += cpu;
+  prof->wall   += wall;
+  prof->allocs += allocs;
+  prof->max     = MAX(prof->max, wall);
+
+  /* Update rolling averages */
+  if(0 < prof->calls++)
+    {
+      prof->avgcpu    = PROFILE_AVG(prof->avgcpu,    cpu);
+      prof->avgwall   = PROFILE_AVG(prof->avgwall,   wall);
+      prof->avgallocs = PROFILE_AVG(prof->avgallocs, allocs);
+    }
+  else
+    {
+      prof->avgcpu    = cpu;
+      prof->avgwall   = wall;
+      prof->avgallocs = allocs;
+    }
+
+  dirty = True;
+} /* }}} */
+
+ /** subPanelProfileRender {{{
+  * @brief Split render time among sublets parsed since last render
+  * @param[in]  render  Render time in usec
+  **/
+
+void
+subPanelProfileRender(unsigned long render)
+{
+  int i, n = 0;
+
+  /* Count parsed sublets */
+  for(i = 0; i < subtle->sublets->ndata; i++)
+    if(PANEL(subtle->sublets->data[i])->sublet->flags & SUB_SUBLET_PARSED)
+      n++;
+
+  if(0 == n) return;
+
+  render /= n;
+
+  for(i = 0; i < subtle->sublets->ndata; i++)
+    {
+      SubSublet *s = PANEL(subtle->sublets->data[i])->sublet;
+
+      if(s->flags & SUB_SUBLET_PARSED)
+        {
+          s->profile.render   += render;
+          s->profile.avgrender = s->profile.avgrender ?
+            PROFILE_AVG(s->profile.avgrender, render) : render;
+          s->flags            &= ~SUB_SUBLET_PARSED;
+        }
+    }
+
+  dirty = True;
+} /* }}} */
+
+ /** subPanelProfilePublish {{{
+  * @brief Publish sublet stats at most once per second and log them
+  *        if enabled
+  **/
+
+void
+subPanelProfilePublish(void)
+{
+  int i, j, idx = 0;
+  long *stats = NULL;
+  time_t now = 0;
+
+  /* Check for changes and throttle */
+  if(!dirty || (now = subSubtleTime()) == published) return;
+
+  stats = (long *)subSharedMemoryAlloc(subtle->sublets->ndata *
+    PROFILE_FIELDS, sizeof(long));
+
+  /* Use same order as sublet list */
+  for(i = 0; i < subtle->screens->ndata; i++)
+    {
+      SubScreen *s = SCREEN(subtle->screens->data[i]);
+
+      if(s->panels)
+        {
+          for(j = 0; j < s->panels->ndata; j++)
+            {
+              SubPanel *p = PANEL(s->panels->data[j]);
+
+              if(p->flags & SUB_PANEL_SUBLET && !(p->flags & SUB_PANEL_COPY) &&
+                  idx < subtle->sublets->ndata)
+                {
+                  SubProfile *prof = &p->sublet->profile;
+                  long *v = &stats[idx++ * PROFILE_FIELDS];
+
+                  v[0] = prof->calls;
+                  v[1] = prof->cpu / 1000;
+                  v[2] = prof->wall / 1000;
+                  v[3] = prof->avgcpu;
+                  v[4] = prof->avgwall;
+                  v[5] = prof->max;
+                  v[6] = prof->avgallocs;
+                  v[7] = prof->avgrender;
+
+                  /* Dump stats */
+                  if(0 < subtle->stats && now >= logged + subtle->stats)
+                    printf("Sublet stats (%s): calls=%ld, cpu=%ldms, "
+                      "wall=%ldms, avg=%ldus, max=%ldus, allocs=%ld, "
+                      "render=%ldus\n", p->sublet->name, v[0], v[1], v[2],
+                      v[4], v[5], v[6], v[7]);
+                }
+            }
+        }
+    }
+
+  /* EWMH: Sublet stats */
+  subEwmhSetCardinals(ROOT, SUB_EWMH_SUBTLE_SUBLET_STATS, stats,
+    idx * PROFILE_FIELDS);
+
+  free(stats);
+
+  if(0 < subtle->stats && now >= logged + subtle->stats) logged = now;
+
+  dirty     = False;
+  published = now;
+} /* }}} */
+
  /** subPanelKill {{{
   * @brief Kill a panel
   * @param[in]  p  A #SubPanel
@@ -635,11 +812,17 @@ subPanelKill(SubPanel *p)
         if(!(p->flags & SUB_PANEL_COPY))
           {
             /* Call unload */
-            if(p->sublet->flags & SUB_SUBLET_UNLOAD)
+            if(p->sublet->flags & SUB_SUBLET_NATIVE)
+              subNativeKill(p);
+            else if(p->sublet->flags & SUB_SUBLET_UNLOAD)
               subRubyCall(SUB_CALL_UNLOAD, p->sublet->instance, NULL);
 
             subRubyRelease(p->sublet->instance);
 
+            /* Stop helper */
+            if(p->sublet->flags & SUB_SUBLET_FORK)
+              subRubyHelperKill(p, False);
+
             /* Remove socket watch */
             if(p->sublet->flags & SUB_SUBLET_SOCKET)
               {
@@ -664,6 +847,8 @@ subPanelKill(SubPanel *p)
                 free(p->sublet->name);
               }
             if(p->sublet->text) subSharedTextFree(p->sublet->text);
+            if(p->sublet->input) free(p->sublet->input);
+            if(p->sublet->chunk) subRubyRelease(p->sublet->chunk);
 
             free(p->sublet);
           }
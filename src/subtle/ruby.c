@@ -17,6 +17,11 @@
 #include <fnmatch.h>
 #include <fcntl.h>
 #include <ctype.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/stat.h>
+#include <arpa/inet.h>
 #include <ruby.h>
 #include <ruby/encoding.h>
 #include "subtle.h"
@@ -28,11 +33,43 @@
 /* Macros {{{ */
 #define CHAR2SYM(name) ID2SYM(rb_intern(name))
 #define SYM2CHAR(sym)  rb_id2name(SYM2ID(sym))
+
+#define HELPER_DONE     0L                                        ///< Helper call done
+#define HELPER_DATA     1L                                        ///< Helper sublet data
+#define HELPER_INTERVAL 2L                                        ///< Helper sublet interval
+#define HELPER_SHOW     3L                                        ///< Helper show sublet
+#define HELPER_HIDE     4L                                        ///< Helper hide sublet
+#define HELPER_MAXLEN   (1L << 16)                                ///< Helper max message length
+#define HELPER_BUDGET   2000000ULL                                ///< Helper min call budget in usec
+
+#define BUDGET_DEFAULT  1000                                      ///< Budget default in ms
+#define BUDGET_LIMIT    4                                         ///< Budget factor until interrupt
+#define BUDGET_HANGS    3                                         ///< Budget hangs until unload
+#define BUDGET_BACKOFF  16                                        ///< Budget max interval backoff
+
+#define GC_THRESHOLD    10000                                     ///< GC allocations until idle run
+
+#define DRAIN_CHUNK     4096                                      ///< Drain initial buffer size
+#define DRAIN_MAX       (1L << 20)                                ///< Drain max buffer size
 /* }}} */
 
 /* Globals {{{ */
 static VALUE shelter = Qnil, mod = Qnil, config_sublets = Qnil;
 static VALUE config_instance = Qnil, config_methods = Qnil;
+static VALUE config_resolve = Qnil; ///< Resolved grabs and patterns
+static int helper = -1; ///< Socket to subtle inside of sublet helpers
+static int expired = False, deferred = False;
+static unsigned long long watchdog = 0; ///< Watchdog deadline in usec
+static size_t collected = 0;
+static SubProfile gc = { 0 };
+static VALUE klass_client = Qnil, klass_screen = Qnil, klass_tag = Qnil;
+static VALUE klass_view = Qnil, klass_geometry = Qnil;
+static ID id_new = 0, iv_win = 0, iv_flags = 0, iv_name = 0, iv_instance = 0;
+static ID iv_klass = 0, iv_role = 0, iv_geometry = 0, iv_gravity = 0;
+static ID iv_screen = 0, iv_id = 0, iv_x = 0, iv_y = 0, iv_width = 0;
+static ID iv_height = 0;
+static ID id_configure = 0, id_run = 0, id_data = 0, id_watch = 0;
+static ID id_down = 0, id_over = 0, id_out = 0, id_unload = 0, id_call = 0;
 /* }}} */
 
 /* Typedef {{{ */
@@ -47,8 +84,38 @@ typedef struct rubymethods_t
   VALUE sym, real;
   int   flags, arity;
 } RubyMethods;
+
+typedef struct rubyhelper_t
+{
+  int type, value, len;
+} RubyHelper;
+
+typedef struct rubyhook_t
+{
+  const char *name;
+  int        flags;
+} RubyHooks;
 /* }}} */
 
+/* Hooks {{{ */
+static RubyHooks hooks[] =
+{
+  { "start",          SUB_HOOK_START                                 },
+  { "exit",           SUB_HOOK_EXIT                                  },
+  { "tile",           SUB_HOOK_TILE                                  },
+  { "reload",         SUB_HOOK_RELOAD                                },
+  { "client_create",  (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_CREATE)  },
+  { "client_mode",    (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_MODE)    },
+  { "client_gravity", (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_GRAVITY) },
+  { "client_focus",   (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_FOCUS)   },
+  { "client_kill",    (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_KILL)    },
+  { "tag_create",     (SUB_HOOK_TYPE_TAG|SUB_HOOK_ACTION_CREATE)     },
+  { "tag_kill",       (SUB_HOOK_TYPE_TAG|SUB_HOOK_ACTION_KILL)       },
+  { "view_create",    (SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_CREATE)    },
+  { "view_jump",      (SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_FOCUS)     },
+  { "view_kill",      (SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_KILL)      }
+}; /* }}} */
+
 /* RubyBacktrace {{{ */
 static void
 RubyBacktrace(void)
@@ -73,6 +140,110 @@ RubyBacktrace(void)
     }
 } /* }}} */
 
+/* RubyAllocations {{{ */
+static size_t
+RubyAllocations(void)
+{
+#ifdef HAVE_RB_GC_STAT
+  static VALUE key = Qnil;
+
+  /* Count of allocated objects since start */
+  if(NIL_P(key)) key = CHAR2SYM("total_allocated_objects");
+
+  return rb_gc_stat(key);
+#else /* HAVE_RB_GC_STAT */
+  return 0;
+#endif /* HAVE_RB_GC_STAT */
+} /* }}} */
+
+/* RubyWatchdogArm {{{ */
+static int
+RubyWatchdogArm(SubPanel *p)
+{
+  long ms = 0;
+  struct itimerval timer = { { 0 } };
+
+  /* Nested calls share the outer timer */
+  if(watchdog) return False;
+
+  ms = (long)(p->sublet->budget ? p->sublet->budget :
+    BUDGET_DEFAULT) * BUDGET_LIMIT;
+
+  timer.it_value.tv_sec  = ms / 1000;
+  timer.it_value.tv_usec = (ms % 1000) * 1000;
+
+  /* Set deadline before timer, so it can't fire earlier */
+  watchdog = subSubtleClock(CLOCK_MONOTONIC) + ms * 1000ULL;
+  expired  = False;
+
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+  return True;
+} /* }}} */
+
+/* RubyWatchdogDisarm {{{ */
+static void
+RubyWatchdogDisarm(void)
+{
+  struct itimerval timer = { { 0 } };
+
+  setitimer(ITIMER_REAL, &timer, NULL);
+
+  watchdog = 0;
+} /* }}} */
+
+/* RubyBudget {{{ */
+static void
+RubyBudget(int type,
+  SubPanel *p,
+  unsigned long wall)
+{
+  unsigned long budget = (p->sublet->budget ? p->sublet->budget :
+    BUDGET_DEFAULT) * 1000UL;
+
+  /* Count hangs */
+  if(expired)
+    {
+      expired = False;
+
+      if(BUDGET_HANGS <= ++p->sublet->hangs)
+        {
+          subSharedLogWarn("Unloading sublet `%s' after %d hangs\n",
+            p->sublet->name, p->sublet->hangs);
+
+          p->sublet->flags |= SUB_SUBLET_HUNG; ///< Unload in event loop
+        }
+      else subSharedLogWarn("Interrupted sublet `%s' after %lums\n",
+        p->sublet->name, wall / 1000);
+    }
+  else if(wall <= budget) p->sublet->hangs = 0;
+
+  /* Back off interval */
+  if(SUB_CALL_RUN == type && p->sublet->flags & SUB_SUBLET_INTERVAL)
+    {
+      if(wall > budget)
+        {
+          if(0 == p->sublet->base) p->sublet->base = p->sublet->interval;
+
+          if(p->sublet->interval < p->sublet->base * BUDGET_BACKOFF)
+            {
+              p->sublet->interval *= 2;
+
+              subSharedLogWarn("Sublet `%s' exceeded budget of %dms, "
+                "interval is now %lds\n", p->sublet->name,
+                (int)(budget / 1000), (long)p->sublet->interval);
+            }
+        }
+      else if(p->sublet->base && wall < budget / 2)
+        {
+          p->sublet->interval = MAX(p->sublet->interval / 2,
+            p->sublet->base);
+
+          if(p->sublet->interval == p->sublet->base) p->sublet->base = 0;
+        }
+    }
+} /* }}} */
+
 /* RubyFilter {{{ */
 static inline int
 RubyFilter(const struct dirent *entry)
@@ -80,6 +251,74 @@ RubyFilter(const struct dirent *entry)
   return !fnmatch("*.rb", entry->d_name, FNM_PATHNAME);
 } /* }}} */
 
+/* RubyPanelSymbol {{{ */
+static int
+RubyPanelSymbol(VALUE sym)
+{
+  int i;
+
+  /* Check panel arrays of all screens */
+  for(i = 0; subtle->screens && i < subtle->screens->ndata; i++)
+    {
+      SubScreen *s = SCREEN(subtle->screens->data[i]);
+
+      if((T_ARRAY == rb_type(s->top) &&
+          Qtrue == rb_ary_includes(s->top, sym)) ||
+          (T_ARRAY == rb_type(s->bottom) &&
+          Qtrue == rb_ary_includes(s->bottom, sym)))
+        return True;
+    }
+
+  return False;
+} /* }}} */
+
+/* RubyPanelMissing {{{ */
+static int
+RubyPanelMissing(void)
+{
+  int i, j, k, l;
+  VALUE entry = Qnil;
+  const char *items[] = {
+    "tray", "spacer", "center", "separator", "sublets", "views", "title",
+    "keychain"
+  };
+
+  /* Find panel symbols that are neither items nor sublets */
+  for(i = 0; subtle->screens && i < subtle->screens->ndata; i++)
+    {
+      SubScreen *s = SCREEN(subtle->screens->data[i]);
+      VALUE arys[2] = { s->top, s->bottom };
+
+      for(j = 0; j < LENGTH(arys); j++)
+        {
+          if(T_ARRAY != rb_type(arys[j])) continue;
+
+          for(k = 0; Qnil != (entry = rb_ary_entry(arys[j], k)); k++)
+            {
+              const char *name = NULL;
+
+              if(T_SYMBOL != rb_type(entry)) continue;
+
+              name = SYM2CHAR(entry);
+
+              for(l = 0; l < LENGTH(items); l++)
+                if(0 == strcmp(items[l], name)) break;
+
+              if(l < LENGTH(items)) continue;
+
+              for(l = 0; l < subtle->sublets->ndata; l++)
+                if(0 == strcmp(PANEL(subtle->sublets->data[l])->sublet->name,
+                    name)) break;
+
+              if(l == subtle->sublets->ndata && !subNativeFind(name))
+                return True;
+            }
+        }
+    }
+
+  return False;
+} /* }}} */
+
 /* RubyReceiver {{{ */
 static int
 RubyReceiver(unsigned long instance,
@@ -96,6 +335,79 @@ RubyReceiver(unsigned long instance,
 
 /* Type converter */
 
+/* RubySubtlextClass {{{ */
+static VALUE
+RubySubtlextClass(VALUE *klass,
+  const char *name)
+{
+  /* Look up class once */
+  if(NIL_P(*klass))
+    {
+      *klass = rb_const_get(rb_const_get(rb_mKernel,
+        rb_intern("Subtlext")), rb_intern(name));
+    }
+
+  return *klass;
+} /* }}} */
+
+/* RubyWrapperGet {{{ */
+static VALUE
+RubyWrapperGet(unsigned long *object,
+  VALUE klass,
+  VALUE arg)
+{
+  /* Create missing and replace frozen wrappers */
+  if(!*object || OBJ_FROZEN((VALUE)*object))
+    {
+      if(*object) subRubyRelease(*object);
+
+      *object = rb_funcall(klass, id_new, 1, arg);
+
+      rb_hash_aset(shelter, *object, Qtrue); ///< Protect from GC
+    }
+
+  return (VALUE)*object;
+} /* }}} */
+
+/* RubyWrapperString {{{ */
+static void
+RubyWrapperString(VALUE object,
+  ID iv,
+  const char *str)
+{
+  VALUE value = rb_ivar_get(object, iv);
+
+  /* Only allocate changed strings */
+  if(!str)
+    {
+      if(!NIL_P(value)) rb_ivar_set(object, iv, Qnil);
+    }
+  else if(T_STRING != rb_type(value) || 0 != strcmp(RSTRING_PTR(value), str))
+    rb_ivar_set(object, iv, rb_str_new2(str));
+} /* }}} */
+
+/* RubyWrapperGeometry {{{ */
+static void
+RubyWrapperGeometry(VALUE object,
+  XRectangle *geom)
+{
+  VALUE value = rb_ivar_get(object, iv_geometry);
+
+  /* Only allocate changed geometries */
+  if(NIL_P(value) || OBJ_FROZEN(value) ||
+      INT2FIX(geom->x)      != rb_ivar_get(value, iv_x)     ||
+      INT2FIX(geom->y)      != rb_ivar_get(value, iv_y)     ||
+      INT2FIX(geom->width)  != rb_ivar_get(value, iv_width) ||
+      INT2FIX(geom->height) != rb_ivar_get(value, iv_height))
+    {
+      value = rb_funcall(RubySubtlextClass(&klass_geometry, "Geometry"),
+        id_new, 4, INT2FIX(geom->x), INT2FIX(geom->y),
+        INT2FIX(geom->width), INT2FIX(geom->height));
+
+      rb_ivar_set(object, iv_geometry, value);
+    }
+} /* }}} */
+
 /* RubySubtleToSubtlext {{{ */
 static VALUE
 RubySubtleToSubtlext(void *data)
@@ -107,76 +419,71 @@ RubySubtleToSubtlext(void *data)
   if((c = CLIENT(data)))
     {
       int id = 0;
-      VALUE subtlext = Qnil, klass = Qnil;
-
-      XSync(subtle->dpy, False); ///< Sync before going on
 
-      subtlext = rb_const_get(rb_mKernel, rb_intern("Subtlext"));
+      XFlush(subtle->dpy); ///< Flush before going on
 
       if(c->flags & SUB_TYPE_CLIENT) /* {{{ */
         {
           int flags = 0;
 
-          /* Create client instance */
+          /* Get client instance */
           id     = subArrayIndex(subtle->clients, (void *)c);
-          klass  = rb_const_get(subtlext, rb_intern("Client"));
-          object = rb_funcall(klass, rb_intern("new"), 1, INT2FIX(id));
+          object = RubyWrapperGet(&c->object,
+            RubySubtlextClass(&klass_client, "Client"), INT2FIX(id));
 
           /* Translate flags */
           subEwmhTranslateClientMode(c->flags, &flags);
 
-          /* Set properties */
-          rb_iv_set(object, "@win",      LONG2NUM(c->win));
-          rb_iv_set(object, "@flags",    INT2FIX(flags));
-          rb_iv_set(object, "@name",     rb_str_new2(c->name));
-          rb_iv_set(object, "@instance", rb_str_new2(c->instance));
-          rb_iv_set(object, "@klass",    rb_str_new2(c->klass));
-          rb_iv_set(object, "@role",     c->role ? rb_str_new2(c->role) : Qnil);
+          /* Update properties */
+          rb_ivar_set(object, iv_win,   LONG2NUM(c->win));
+          rb_ivar_set(object, iv_flags, INT2FIX(flags));
+
+          RubyWrapperString(object, iv_name,     c->name);
+          RubyWrapperString(object, iv_instance, c->instance);
+          RubyWrapperString(object, iv_klass,    c->klass);
+          RubyWrapperString(object, iv_role,     c->role);
 
           /* Set to nil for on demand loading */
-          rb_iv_set(object, "@geometry", Qnil);
-          rb_iv_set(object, "@gravity",  Qnil);
+          rb_ivar_set(object, iv_geometry, Qnil);
+          rb_ivar_set(object, iv_gravity,  Qnil);
+          rb_ivar_set(object, iv_screen,   Qnil);
         } /* }}} */
       else if(c->flags & SUB_TYPE_SCREEN) /* {{{ */
         {
           SubScreen *s = SCREEN(c);
-          VALUE klass_geom, geom = Qnil;
-
-          /* Create tag instance */
-          id         = subArrayIndex(subtle->screens, (void *)s);
-          klass      = rb_const_get(subtlext, rb_intern("Screen"));
-          klass_geom = rb_const_get(subtlext, rb_intern("Geometry"));
-          object     = rb_funcall(klass, rb_intern("new"), 1, INT2FIX(id));
-          geom       = rb_funcall(klass_geom, rb_intern("new"), 4,
-            INT2FIX(s->geom.x), INT2FIX(s->geom.y),
-            INT2FIX(s->geom.width), INT2FIX(s->geom.height));
-
-          /* Set properties */
-          rb_iv_set(object, "@geometry", geom);
+
+          /* Get screen instance */
+          id     = subArrayIndex(subtle->screens, (void *)s);
+          object = RubyWrapperGet(&s->object,
+            RubySubtlextClass(&klass_screen, "Screen"), INT2FIX(id));
+
+          /* Update properties */
+          rb_ivar_set(object, iv_id, INT2FIX(id));
+          RubyWrapperGeometry(object, &s->geom);
         } /* }}} */
       else if(c->flags & SUB_TYPE_TAG) /* {{{ */
         {
           SubTag *t = TAG(c);
 
-          /* Create tag instance */
+          /* Get tag instance */
           id     = subArrayIndex(subtle->tags, (void *)t);
-          klass  = rb_const_get(subtlext, rb_intern("Tag"));
-          object = rb_funcall(klass, rb_intern("new"), 1, rb_str_new2(t->name));
+          object = RubyWrapperGet(&t->object,
+            RubySubtlextClass(&klass_tag, "Tag"), rb_str_new2(t->name));
 
-          /* Set properties */
-          rb_iv_set(object, "@id", INT2FIX(id));
+          /* Update properties */
+          rb_ivar_set(object, iv_id, INT2FIX(id));
         } /* }}} */
       else if(c->flags & SUB_TYPE_VIEW) /* {{{ */
         {
           SubView *v = VIEW(c);
 
-          /* Create view instance */
+          /* Get view instance */
           id     = subArrayIndex(subtle->views, (void *)v);
-          klass  = rb_const_get(subtlext, rb_intern("View"));
-          object = rb_funcall(klass, rb_intern("new"), 1, rb_str_new2(v->name));
+          object = RubyWrapperGet(&v->object,
+            RubySubtlextClass(&klass_view, "View"), rb_str_new2(v->name));
 
-          /* Set properties */
-          rb_iv_set(object, "@id",  INT2FIX(id));
+          /* Update properties */
+          rb_ivar_set(object, iv_id, INT2FIX(id));
         } /* }}} */
     }
 
@@ -364,14 +671,14 @@ RubyValueToIcon(VALUE value)
           {
             icon = value; ///< Lazy eval
 
-            rb_ary_push(shelter, icon); ///< Protect from GC
+            rb_hash_aset(shelter, icon, Qtrue); ///< Protect from GC
           }
         break;
       case T_STRING:
         /* Create new text icon */
         icon  = rb_funcall(klass, rb_intern("new"), 1, value);
 
-        rb_ary_push(shelter, icon); ///< Protect from GC
+        rb_hash_aset(shelter, icon, Qtrue); ///< Protect from GC
         break;
       default: break;
     }
@@ -455,6 +762,326 @@ RubyHashToBorder(VALUE hash,
     }
 } /* }}} */
 
+/* RubyDataProperty {{{ */
+static char *
+RubyDataProperty(void)
+{
+  int nlist = 0;
+  char **list = NULL, *ret = NULL;
+  Atom prop = subEwmhGet(SUB_EWMH_SUBTLE_DATA);
+
+  /* Get data */
+  if((list = subSharedPropertyGetStrings(subtle->dpy, ROOT,
+      prop, &nlist)))
+    {
+      if(0 < nlist) ret = strdup(list[0]);
+
+      XFreeStringList(list);
+    }
+
+  subSharedPropertyDelete(subtle->dpy, ROOT, prop);
+
+  return ret;
+} /* }}} */
+
+/* Helper */
+
+/* RubyHelperRead {{{ */
+static int
+RubyHelperRead(int fd,
+  char *buf,
+  size_t len)
+{
+  ssize_t n = 0;
+  size_t nread = 0;
+  struct pollfd pfd = { fd, POLLIN, 0 };
+
+  /* Read until message is complete */
+  while(nread < len)
+    {
+      if(0 < (n = read(fd, buf + nread, len - nread))) nread += n;
+      else if(0 == n) return False; ///< Connection closed
+      else if(EINTR == errno) continue;
+      else if(EAGAIN == errno && 0 < poll(&pfd, 1, WAITTIME * 100)) continue;
+      else return False;
+    }
+
+  return True;
+} /* }}} */
+
+/* RubyHelperRecv {{{ */
+static int
+RubyHelperRecv(int fd,
+  RubyHelper *msg,
+  char **data)
+{
+  *data = NULL;
+
+  /* Read header */
+  if(!RubyHelperRead(fd, (char *)msg, sizeof(RubyHelper)) ||
+      0 > msg->len || HELPER_MAXLEN < msg->len)
+    return False;
+
+  /* Read payload */
+  if(0 < msg->len)
+    {
+      *data = (char *)subSharedMemoryAlloc(msg->len + 1, sizeof(char));
+
+      if(!RubyHelperRead(fd, *data, msg->len))
+        {
+          free(*data);
+          *data = NULL;
+
+          return False;
+        }
+    }
+
+  return True;
+} /* }}} */
+
+/* RubyHelperSend {{{ */
+static int
+RubyHelperSend(int fd,
+  int type,
+  int value,
+  const void *data,
+  int len)
+{
+  ssize_t n = 0;
+  size_t size = 0, written = 0;
+  char *buf = NULL;
+  RubyHelper *msg = NULL;
+
+  /* Assemble message to write it at once */
+  size = sizeof(RubyHelper) + len;
+  buf  = (char *)subSharedMemoryAlloc(1, size);
+  msg  = (RubyHelper *)buf;
+
+  msg->type  = type;
+  msg->value = value;
+  msg->len   = len;
+
+  if(0 < len) memcpy(buf + sizeof(RubyHelper), data, len);
+
+  while(written < size)
+    {
+      if(0 < (n = write(fd, buf + written, size - written))) written += n;
+      else if(0 > n && EINTR == errno) continue;
+      else break;
+    }
+
+  free(buf);
+
+  return written == size;
+} /* }}} */
+
+/* RubyHelperLoop {{{ */
+static void
+RubyHelperLoop(SubPanel *p)
+{
+  int nfds = 1;
+  char *data = NULL;
+  RubyHelper msg;
+  struct pollfd fds[2];
+
+  while(1)
+    {
+      /* Helper socket */
+      fds[0].fd      = helper;
+      fds[0].events  = POLLIN;
+      fds[0].revents = 0;
+      nfds           = 1;
+
+      /* Socket watch belongs to the helper, inotify stays in subtle */
+      if(p->sublet->flags & SUB_SUBLET_SOCKET)
+        {
+          fds[1].fd      = p->sublet->watch;
+          fds[1].events  = POLLIN;
+          fds[1].revents = 0;
+          nfds++;
+        }
+
+      if(0 > poll(fds, nfds, -1))
+        {
+          if(EINTR == errno) continue;
+
+          break;
+        }
+
+      /* Requests from subtle */
+      if(0 != fds[0].revents)
+        {
+          if(!RubyHelperRecv(helper, &msg, &data)) break; ///< subtle is gone
+
+          /* Don't let unload block forever */
+          if(SUB_CALL_UNLOAD == msg.type) alarm(WAITTIME);
+
+          subRubyCall(msg.type, p->sublet->instance, (void *)data);
+          RubyHelperSend(helper, HELPER_DONE, 0, NULL, 0);
+
+          if(data) free(data);
+          if(SUB_CALL_UNLOAD == msg.type) break;
+        }
+
+      /* Watch events */
+      if(1 < nfds && 0 != fds[1].revents)
+        subRubyCall(SUB_CALL_WATCH, p->sublet->instance, NULL);
+    }
+} /* }}} */
+
+/* RubyHelperSpawn {{{ */
+static int
+RubyHelperSpawn(SubPanel *p)
+{
+  int i, flags = 0, null = -1, fds[2] = { -1, -1 };
+  pid_t pid = 0;
+
+  /* Create socket pair */
+  if(-1 == socketpair(AF_UNIX, SOCK_STREAM, 0, fds))
+    {
+      subSharedLogWarn("Failed creating socket for sublet `%s': %s\n",
+        p->sublet->name, strerror(errno));
+
+      return False;
+    }
+
+  switch((pid = fork()))
+    {
+      case -1: /* {{{ */
+        subSharedLogWarn("Failed forking sublet `%s': %s\n",
+          p->sublet->name, strerror(errno));
+
+        close(fds[0]);
+        close(fds[1]);
+
+        return False; /* }}} */
+      case 0: /* {{{ */
+        /* Drop descriptors of subtle and other helpers; the display
+         * descriptor stays occupied so nothing else can reuse it */
+        close(fds[0]);
+
+        if(-1 != (null = open("/dev/null", O_RDWR)))
+          {
+            dup2(null, ConnectionNumber(subtle->dpy));
+            close(null);
+          }
+
+        for(i = 0; i < subtle->sublets->ndata; i++)
+          {
+            SubPanel *other = PANEL(subtle->sublets->data[i]);
+
+            if(other != p && 0 < other->sublet->pid)
+              close(other->sublet->helper);
+          }
+
+        signal(SIGCHLD, SIG_DFL);
+        signal(SIGHUP,  SIG_DFL);
+        signal(SIGINT,  SIG_DFL);
+        signal(SIGALRM, SIG_DFL);
+
+        rb_thread_atfork();
+
+        helper = fds[1];
+
+        RubyHelperLoop(p);
+
+        _exit(0); /* }}} */
+      default: /* {{{ */
+        close(fds[1]);
+
+        p->sublet->pid    = pid;
+        p->sublet->helper = fds[0];
+
+        /* Set nonblocking and don't leak into restarts */
+        if(-1 == (flags = fcntl(fds[0], F_GETFL, 0))) flags = 0;
+        fcntl(fds[0], F_SETFL, flags | O_NONBLOCK);
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+
+        XSaveContext(subtle->dpy, subtle->windows.support,
+          p->sublet->helper, (void *)p);
+        subEventWatchAdd(p->sublet->helper);
+
+        /* Helper polls the socket watch from now on */
+        if(p->sublet->flags & SUB_SUBLET_SOCKET)
+          subEventWatchDel(p->sublet->watch);
+
+        subSharedLogDebugRuby("helper=%s, pid=%d\n", p->sublet->name, pid);
+        /* }}} */
+    }
+
+  return True;
+} /* }}} */
+
+/* RubyHelperCall {{{ */
+static int
+RubyHelperCall(int type,
+  SubPanel *p,
+  void *data)
+{
+  int len = 0, ret = True;
+  char *str = NULL;
+
+  /* Skip runs and watches and kill stuck helpers on unload */
+  if(p->sublet->flags & SUB_SUBLET_BUSY)
+    {
+      if(SUB_CALL_RUN == type || SUB_CALL_WATCH == type) return True;
+      else if(SUB_CALL_UNLOAD == type)
+        {
+          subRubyHelperKill(p, True);
+
+          return True;
+        }
+    }
+
+  /* Spawn helper on demand */
+  if(0 == p->sublet->pid)
+    {
+      if(SUB_CALL_UNLOAD == type) return True; ///< Nothing to unload
+      else if(!RubyHelperSpawn(p)) return False;
+
+      /* New helper reads the pending socket data itself */
+      if(SUB_CALL_WATCH == type && p->sublet->flags & SUB_SUBLET_SOCKET)
+        return True;
+    }
+
+  /* Collect payload */
+  switch(type)
+    {
+      case SUB_CALL_DATA: ///< Batched data is passed directly
+        if(data || (data = str = RubyDataProperty()))
+          len = strlen((char *)data) + 1;
+        break;
+      case SUB_CALL_DOWN:
+        len = 3 * sizeof(int);
+        break;
+      default: data = NULL;
+    }
+
+  if(RubyHelperSend(p->sublet->helper, type, 0, data, len))
+    {
+      /* Start deadline */
+      if(!(p->sublet->flags & SUB_SUBLET_BUSY))
+        {
+          p->sublet->flags    |= SUB_SUBLET_BUSY;
+          p->sublet->deadline  = subSubtleClock(CLOCK_MONOTONIC) +
+            MAX(HELPER_BUDGET, 1000000ULL * (0 < p->sublet->timeout ?
+            p->sublet->timeout : p->sublet->interval));
+        }
+    }
+  else
+    {
+      subSharedLogWarn("Failed calling helper of sublet `%s'\n",
+        p->sublet->name);
+
+      subRubyHelperKill(p, True);
+      ret = False;
+    }
+
+  if(str) free(str);
+
+  return ret;
+} /* }}} */
+
 /* Eval */
 
 /* RubyEvalHook {{{ */
@@ -465,36 +1092,29 @@ RubyEvalHook(VALUE event,
   int i;
   SubHook *h = NULL;
 
-  RubySymbols hooks[] =
-  {
-    { CHAR2SYM("start"),          SUB_HOOK_START                                 },
-    { CHAR2SYM("exit"),           SUB_HOOK_EXIT                                  },
-    { CHAR2SYM("tile"),           SUB_HOOK_TILE                                  },
-    { CHAR2SYM("reload"),         SUB_HOOK_RELOAD                                },
-    { CHAR2SYM("client_create"),  (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_CREATE)  },
-    { CHAR2SYM("client_mode"),    (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_MODE)    },
-    { CHAR2SYM("client_gravity"), (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_GRAVITY) },
-    { CHAR2SYM("client_focus"),   (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_FOCUS)   },
-    { CHAR2SYM("client_kill"),    (SUB_HOOK_TYPE_CLIENT|SUB_HOOK_ACTION_KILL)    },
-    { CHAR2SYM("tag_create"),     (SUB_HOOK_TYPE_TAG|SUB_HOOK_ACTION_CREATE)     },
-    { CHAR2SYM("tag_kill"),       (SUB_HOOK_TYPE_TAG|SUB_HOOK_ACTION_KILL)       },
-    { CHAR2SYM("view_create"),    (SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_CREATE)    },
-    { CHAR2SYM("view_jump"),      (SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_FOCUS)     },
-    { CHAR2SYM("view_kill"),      (SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_KILL)      }
-  };
-
   if(subtle->flags & SUB_SUBTLE_CHECK) return; ///< Skip on check
 
   /* Generic hooks */
   for(i = 0; LENGTH(hooks) > i; i++)
     {
-      if(hooks[i].sym == event)
+      if(CHAR2SYM(hooks[i].name) == event)
         {
           /* Create new hook */
           if((h = subHookNew(hooks[i].flags, proc)))
             {
+              /* Cache arity and receiver of instance methods */
+              if(rb_obj_is_instance_of(proc, rb_cMethod))
+                {
+                  h->receiver = rb_funcall(proc, rb_intern("receiver"),
+                    0, NULL);
+                  h->arity    = FIX2INT(rb_funcall(proc, rb_intern("arity"),
+                    0, NULL));
+                  h->arity    = -1 == h->arity ? 2 : MINMAX(h->arity, 1, 2);
+                }
+              else h->arity = MINMAX(rb_proc_arity(proc), 0, 1);
+
               subArrayPush(subtle->hooks, (void *)h);
-              rb_ary_push(shelter, proc); ///< Protect from GC
+              rb_hash_aset(shelter, proc, Qtrue); ///< Protect from GC
             }
 
           break;
@@ -502,6 +1122,36 @@ RubyEvalHook(VALUE event,
     }
 } /* }}} */
 
+/* RubyGrabNew {{{ */
+static SubGrab *
+RubyGrabNew(char *keys,
+  int *duplicate)
+{
+  SubGrab *g = NULL;
+  VALUE grabs = Qnil, key = Qnil, entry = Qnil;
+
+  if(NIL_P(config_resolve)) return subGrabNew(keys, duplicate);
+
+  grabs = rb_ary_entry(config_resolve, 2);
+  key   = rb_str_new2(keys);
+
+  /* Skip key parsing for resolved grabs */
+  if(T_ARRAY == rb_type(entry = rb_hash_lookup(grabs, key)))
+    {
+      g = subGrabNewCode(NUM2UINT(rb_ary_entry(entry, 0)),
+        NUM2UINT(rb_ary_entry(entry, 1)), RTEST(rb_ary_entry(entry, 2)),
+        duplicate);
+    }
+  else if((g = subGrabNew(keys, duplicate)))
+    {
+      rb_hash_aset(grabs, key, rb_ary_new3(3, UINT2NUM(g->code),
+        UINT2NUM(g->state), g->flags & SUB_GRAB_MOUSE ? Qtrue : Qfalse));
+      rb_ary_store(config_resolve, 4, Qfalse); ///< Mark as changed
+    }
+
+  return g;
+} /* }}} */
+
 /* RubyEvalGrab {{{ */
 static void
 RubyEvalGrab(VALUE keys,
@@ -684,7 +1334,7 @@ RubyEvalGrab(VALUE keys,
         type = (SUB_GRAB_WINDOW_GRAVITY|SUB_RUBY_DATA);
         data = DATA((unsigned long)value);
 
-        rb_ary_push(shelter, value); ///< Protect from GC
+        rb_hash_aset(shelter, value, Qtrue); ///< Protect from GC
         break; /* }}} */
       case T_STRING: /* {{{ */
         type = SUB_GRAB_SPAWN;
@@ -694,7 +1344,7 @@ RubyEvalGrab(VALUE keys,
         type = SUB_GRAB_PROC;
         data = DATA(value);
 
-        rb_ary_push(shelter, value); ///< Protect from GC
+        rb_hash_aset(shelter, value, Qtrue); ///< Protect from GC
         break; /* }}} */
       default:
         subSharedLogWarn("Unknown value type for grab\n");
@@ -719,7 +1369,7 @@ RubyEvalGrab(VALUE keys,
           while(tok)
             {
               /* Find or create grab */
-              if((g = subGrabNew(tok, &duplicate)))
+              if((g = RubyGrabNew(tok, &duplicate)))
                 {
                   if(!duplicate)
                     {
@@ -886,7 +1536,7 @@ RubyEvalPanel(VALUE ary,
 
                   RubyIconToIcon(entry, p->icon);
 
-                  rb_ary_push(shelter, entry); ///< Protect from GC
+                  rb_hash_aset(shelter, entry, Qtrue); ///< Protect from GC
                 }
             }
           else
@@ -915,6 +1565,10 @@ RubyEvalPanel(VALUE ary,
                       break;
                     }
                 }
+
+              /* Check for native sublets */
+              if(!p && T_SYMBOL == rb_type(entry))
+                p = subRubyLoadNative(SYM2CHAR(entry));
             }
 
           /* Finally add to panel */
@@ -1245,8 +1899,23 @@ RubyForeachMatcher(VALUE key,
   /* Finally create regex if there is any and append additional flags */
   if(0 < type)
     {
-      subTagMatcherAdd(TAG(rargs[0]), type,
-        NIL_P(regex) ? NULL : RSTRING_PTR(regex), 0 < rargs[1]++);
+      int defer = False;
+      VALUE patterns = Qnil;
+
+      /* Defer compiling of patterns that are known to be valid */
+      if(!NIL_P(config_resolve) && !NIL_P(regex))
+        {
+          patterns = rb_ary_entry(config_resolve, 3);
+          defer    = RTEST(rb_hash_lookup(patterns, regex));
+        }
+
+      if(subTagMatcherAdd(TAG(rargs[0]), type,
+          NIL_P(regex) ? NULL : RSTRING_PTR(regex), 0 < rargs[1]++, defer) &&
+          !NIL_P(patterns) && !defer)
+        {
+          rb_hash_aset(patterns, regex, Qtrue);
+          rb_ary_store(config_resolve, 4, Qfalse); ///< Mark as changed
+        }
     }
 
   return ST_CONTINUE;
@@ -1386,6 +2055,100 @@ RubyWrapLoadPanels(VALUE data)
   return Qnil;
 } /* }}} */
 
+/* RubyDrain {{{ */
+static void
+RubyDrain(SubPanel *p)
+{
+  ssize_t n = 0;
+  SubSublet *s = p->sublet;
+
+  /* Create reusable string once */
+  if(!s->chunk)
+    {
+      s->chunk = rb_str_buf_new(DRAIN_CHUNK);
+      rb_hash_aset(shelter, s->chunk, Qtrue); ///< Protect from GC
+    }
+
+  /* Read available data into buffer */
+  while(True)
+    {
+      if(s->ninput == s->sinput)
+        {
+          if(DRAIN_MAX <= s->sinput) break; ///< Deliver first
+
+          s->sinput = s->sinput ? s->sinput * 2 : DRAIN_CHUNK;
+          s->input  = (char *)subSharedMemoryRealloc(s->input, s->sinput);
+        }
+
+      if(0 >= (n = read(s->watch, s->input + s->ninput,
+          s->sinput - s->ninput)))
+        break;
+
+      s->ninput += n;
+    }
+
+  /* Deliver frames */
+  while(0 < s->ninput)
+    {
+      size_t len = 0, skip = 0, offset = 0;
+
+      if(s->flags & SUB_SUBLET_LINES) ///< Newline terminated
+        {
+          char *nl = memchr(s->input, '\n', s->ninput);
+
+          if(nl) skip = (len = nl - s->input) + 1;
+          else if(0 == n || DRAIN_MAX <= s->ninput) skip = len = s->ninput;
+          else break;
+        }
+      else if(s->flags & SUB_SUBLET_FRAMES) ///< 32-bit length prefixed
+        {
+          uint32_t size = 0;
+
+          if(4 > s->ninput) break;
+
+          memcpy(&size, s->input, 4);
+
+          if(DRAIN_MAX - 4 < (len = ntohl(size)))
+            {
+              subSharedLogWarn("Closing watch of sublet `%s': "
+                "Oversized frame\n", s->name);
+              n = 0; ///< Stream is out of sync, close like on EOF
+
+              break;
+            }
+          else if(s->ninput < 4 + len) break;
+
+          offset = 4;
+          skip   = 4 + len;
+        }
+      else skip = len = s->ninput;
+
+      /* Reuse string and consume frame before calling */
+      rb_str_modify(s->chunk);
+      rb_str_set_len(s->chunk, 0);
+      rb_str_cat(s->chunk, s->input + offset, len);
+
+      s->ninput -= skip;
+      memmove(s->input, s->input + skip, s->ninput);
+
+      rb_funcall(s->instance, id_watch, s->warity, s->instance, s->chunk);
+    }
+
+  /* Remove watch on end of file or protocol error */
+  if(0 == n && s->flags & SUB_SUBLET_SOCKET)
+    {
+      XDeleteContext(subtle->dpy, subtle->windows.support, s->watch);
+      subEventWatchDel(s->watch);
+
+      s->flags  &= ~(SUB_SUBLET_SOCKET|SUB_SUBLET_DRAIN|SUB_SUBLET_LINES|
+        SUB_SUBLET_FRAMES);
+      s->watch   = 0;
+      s->ninput  = 0;
+
+      rb_funcall(s->instance, id_watch, s->warity, s->instance, Qnil);
+    }
+} /* }}} */
+
 /* RubyWrapCall {{{ */
 static VALUE
 RubyWrapCall(VALUE data)
@@ -1396,56 +2159,81 @@ RubyWrapCall(VALUE data)
   switch((int)rargs[0])
     {
       case SUB_CALL_CONFIGURE: /* {{{ */
-        rb_funcall(rargs[1], rb_intern("__configure"), 1, rargs[1]);
+        rb_funcall(rargs[1], id_configure, 1, rargs[1]);
         break; /* }}} */
       case SUB_CALL_RUN: /* {{{ */
-        rb_funcall(rargs[1], rb_intern("__run"), 1, rargs[1]);
+        rb_funcall(rargs[1], id_run, 1, rargs[1]);
         break; /* }}} */
       case SUB_CALL_DATA: /* {{{ */
           {
-            int nlist = 0;
-            char **list = NULL;
-            Atom prop = subEwmhGet(SUB_EWMH_SUBTLE_DATA);
-            VALUE meth = rb_intern("__data"), str = Qnil;
-
-            /* Get data */
-            if((list = subSharedPropertyGetStrings(subtle->dpy, ROOT,
-                prop, &nlist)))
+            char *prop = NULL;
+            VALUE str = Qnil;
+            SubPanel *p = NULL;
+
+            Data_Get_Struct(rargs[1], SubPanel, p);
+
+            /* Get data from helper request or property */
+            if(rargs[2]) str = rb_str_new2((char *)rargs[2]);
+            else if(-1 == helper && (prop = RubyDataProperty()))
               {
-                if(list && 0 < nlist)
-                  str = rb_str_new2(list[0]);
+                str = rb_str_new2(prop);
 
-                XFreeStringList(list);
+                free(prop);
               }
 
-            subSharedPropertyDelete(subtle->dpy, ROOT, prop);
-
-            rb_funcall(rargs[1], meth,
-              MINMAX(rb_obj_method_arity(rargs[1], meth), 1, 2),
-              rargs[1], str);
+            rb_funcall(rargs[1], id_data, p->sublet->darity, rargs[1], str);
           }
         break; /* }}} */
       case SUB_CALL_WATCH: /* {{{ */
-        rb_funcall(rargs[1], rb_intern("__watch"), 1, rargs[1]);
+          {
+            SubPanel *p = NULL;
+
+            Data_Get_Struct(rargs[1], SubPanel, p);
+
+            /* Drain socket or let sublet read */
+            if(p->sublet->flags & SUB_SUBLET_SOCKET &&
+                p->sublet->flags & (SUB_SUBLET_DRAIN|SUB_SUBLET_LINES|
+                SUB_SUBLET_FRAMES))
+              RubyDrain(p);
+            else rb_funcall(rargs[1], id_watch, p->sublet->warity,
+              rargs[1], Qnil);
+          }
         break; /* }}} */
       case SUB_CALL_DOWN: /* {{{ */
           {
             int *args = (int *)rargs[2];
-            VALUE meth = rb_intern("__down");
+            SubPanel *p = NULL;
 
-            rb_funcall(rargs[1], meth,
-              MINMAX(rb_obj_method_arity(rargs[1], meth), 1, 4),
-              rargs[1], INT2FIX(args[0]), INT2FIX(args[1]), INT2FIX(args[2]));
+            Data_Get_Struct(rargs[1], SubPanel, p);
+
+            rb_funcall(rargs[1], id_down, p->sublet->marity, rargs[1], INT2FIX(args[0]), INT2FIX(args[1]), INT2FIX(args[2]));
           }
         break; /* }}} */
       case SUB_CALL_OVER: /* {{{ */
-        rb_funcall(rargs[1], rb_intern("__over"), 1, rargs[1]);
+        rb_funcall(rargs[1], id_over, 1, rargs[1]);
         break; /* }}} */
       case SUB_CALL_OUT: /* {{{ */
-        rb_funcall(rargs[1], rb_intern("__out"), 1, rargs[1]);
+        rb_funcall(rargs[1], id_out, 1, rargs[1]);
         break; /* }}} */
       case SUB_CALL_UNLOAD: /* {{{ */
-        rb_funcall(rargs[1], rb_intern("__unload"), 1, rargs[1]);
+        rb_funcall(rargs[1], id_unload, 1, rargs[1]);
+        break; /* }}} */
+      case SUB_CALL_EMIT: /* {{{ */
+          {
+            SubHook *h = HOOK(rargs[1]);
+
+            /* Call with cached arity and receiver */
+            if(h->receiver)
+              {
+                rb_funcall(h->proc, id_call, h->arity, h->receiver,
+                  RubySubtleToSubtlext((VALUE *)rargs[2]));
+
+                subScreenUpdate();
+                subScreenRender();
+              }
+            else rb_funcall(h->proc, id_call, h->arity,
+              RubySubtleToSubtlext((VALUE *)rargs[2]));
+          }
         break; /* }}} */
       default: /* {{{ */
         /* Call instance methods or just a proc */
@@ -1460,7 +2248,7 @@ RubyWrapCall(VALUE data)
               0, NULL));
             arity    = -1 == arity ? 2 : MINMAX(arity, 1, 2);
 
-            rb_funcall(rargs[1], rb_intern("call"), arity, receiver,
+            rb_funcall(rargs[1], id_call, arity, receiver,
               RubySubtleToSubtlext((VALUE *)rargs[2]));
 
             subScreenUpdate();
@@ -1468,7 +2256,7 @@ RubyWrapCall(VALUE data)
           }
         else
           {
-            rb_funcall(rargs[1], rb_intern("call"),
+            rb_funcall(rargs[1], id_call,
               MINMAX(rb_proc_arity(rargs[1]), 0, 1),
               RubySubtleToSubtlext((VALUE *)rargs[2]));
           }
@@ -1483,12 +2271,29 @@ static VALUE
 RubyWrapRelease(VALUE value)
 {
   /* Relase value from shelter */
-  if(Qtrue == rb_ary_includes(shelter, value))
-    rb_ary_delete(shelter, value);
+  rb_hash_delete(shelter, value);
 
   return Qnil;
 } /* }}} */
 
+/* RubyWrapCollect {{{ */
+static VALUE
+RubyWrapCollect(VALUE data)
+{
+  VALUE opts = rb_hash_new();
+
+  /* Minor marking and lazy sweep keep the pause short */
+  rb_hash_aset(opts, CHAR2SYM("full_mark"),       Qfalse);
+  rb_hash_aset(opts, CHAR2SYM("immediate_sweep"), Qfalse);
+
+#ifdef RB_PASS_KEYWORDS
+  return rb_funcallv_kw(rb_mGC, rb_intern("start"), 1, &opts,
+    RB_PASS_KEYWORDS);
+#else /* RB_PASS_KEYWORDS */
+  return rb_funcall(rb_mGC, rb_intern("start"), 1, opts);
+#endif /* RB_PASS_KEYWORDS */
+} /* }}} */
+
 /* RubyWrapRead {{{ */
 static VALUE
 RubyWrapRead(VALUE file)
@@ -1504,11 +2309,249 @@ RubyWrapEval(VALUE data)
 {
   VALUE *rargs = (VALUE *)data;
 
-  rb_obj_instance_eval(2, rargs, rargs[2]);
+  /* Eval compiled snapshot or source */
+  if(rb_obj_is_proc(rargs[0]))
+    rb_funcall_with_block(rargs[2], rb_intern("instance_exec"),
+      0, NULL, rargs[0]);
+  else rb_obj_instance_eval(2, rargs, rargs[2]);
 
   return Qnil;
 } /* }}} */
 
+/* RubyScoped {{{ */
+static int
+RubyScoped(VALUE node,
+  VALUE klass)
+{
+  int i;
+  VALUE type = Qnil, children = Qnil;
+
+  /* Check for constants and classes */
+  type = rb_funcall(node, rb_intern("type"), 0, NULL);
+  if(CHAR2SYM("CDECL") == type || CHAR2SYM("OP_CDECL") == type ||
+      CHAR2SYM("CLASS") == type || CHAR2SYM("MODULE") == type)
+    return True;
+
+  children = rb_funcall(node, rb_intern("children"), 0, NULL);
+
+  for(i = 0; i < RARRAY_LEN(children); i++)
+    {
+      VALUE child = rb_ary_entry(children, i);
+
+      if(Qtrue == rb_obj_is_kind_of(child, klass) &&
+          RubyScoped(child, klass))
+        return True;
+    }
+
+  return False;
+} /* }}} */
+
+/* RubyWrapCompile {{{ */
+static VALUE
+RubyWrapCompile(VALUE data)
+{
+  long len = 0;
+  VALUE *rargs = (VALUE *)data, klass = Qnil, iseq = Qnil, bin = Qnil;
+
+  klass = rb_path2class("RubyVM::InstructionSequence");
+  len   = RSTRING_LEN(rargs[3]);
+
+  if(!rb_respond_to(klass, rb_intern("load_from_binary")))
+    rb_raise(rb_eNotImpError, "No binary instruction sequences");
+
+  /* Load snapshot if key matches */
+  if(Qtrue == rb_funcall(rb_cFile, rb_intern("exist?"), 1, rargs[2]))
+    {
+      bin = rb_funcall(rb_cFile, rb_intern("binread"), 1, rargs[2]);
+
+      if(RSTRING_LEN(bin) > len &&
+          0 == memcmp(RSTRING_PTR(bin), RSTRING_PTR(rargs[3]), len))
+        {
+          iseq = rb_funcall(klass, rb_intern("load_from_binary"), 1,
+            rb_str_substr(bin, len, RSTRING_LEN(bin) - len));
+
+          subSharedLogDebugRuby("Snapshot hit=%s\n", RSTRING_PTR(rargs[2]));
+        }
+    }
+
+  /* Compile config as proc and store snapshot */
+  if(NIL_P(iseq))
+    {
+      VALUE src = Qnil, ast = Qnil;
+
+      /* Constants and classes of a proc end up in Object instead of
+       * the singleton class of the config instance like in instance_eval */
+      ast = rb_path2class("RubyVM::AbstractSyntaxTree");
+      if(RubyScoped(rb_funcall(ast, rb_intern("parse"), 1, rargs[0]),
+          rb_path2class("RubyVM::AbstractSyntaxTree::Node")))
+        rb_raise(rb_eNotImpError, "Config declares constants");
+
+      src = rb_str_new2("proc do ");
+
+      rb_str_append(src, rargs[0]);
+      rb_str_cat2(src, "\nend");
+
+      iseq = rb_funcall(klass, rb_intern("compile"), 3,
+        src, rargs[1], rargs[1]);
+      bin  = rb_str_dup(rargs[3]);
+
+      rb_str_append(bin, rb_funcall(iseq, rb_intern("to_binary"), 0, NULL));
+      rb_funcall(rb_cFile, rb_intern("binwrite"), 2, rargs[2], bin);
+
+      subSharedLogDebugRuby("Snapshot miss=%s\n", RSTRING_PTR(rargs[2]));
+    }
+
+  return rb_funcall(iseq, rb_intern("eval"), 0, NULL);
+} /* }}} */
+
+/* RubyWrapResolve {{{ */
+static VALUE
+RubyWrapResolve(VALUE data)
+{
+  long len = 0;
+  VALUE *rargs = (VALUE *)data, bin = Qnil;
+
+  len = RSTRING_LEN(rargs[1]);
+
+  /* Load resolved values if key matches */
+  if(Qtrue == rb_funcall(rb_cFile, rb_intern("exist?"), 1, rargs[0]))
+    {
+      bin = rb_funcall(rb_cFile, rb_intern("binread"), 1, rargs[0]);
+
+      if(RSTRING_LEN(bin) > len &&
+          0 == memcmp(RSTRING_PTR(bin), RSTRING_PTR(rargs[1]), len))
+        {
+          subSharedLogDebugRuby("Resolve hit=%s\n", RSTRING_PTR(rargs[0]));
+
+          return rb_marshal_load(rb_str_substr(bin, len,
+            RSTRING_LEN(bin) - len));
+        }
+    }
+
+  subSharedLogDebugRuby("Resolve miss=%s\n", RSTRING_PTR(rargs[0]));
+
+  return Qnil;
+} /* }}} */
+
+/* RubyWrapResolveStore {{{ */
+static VALUE
+RubyWrapResolveStore(VALUE data)
+{
+  VALUE bin = rb_str_dup(rb_ary_entry(config_resolve, 1));
+
+  rb_str_append(bin, rb_marshal_dump(rb_ary_new3(2,
+    rb_ary_entry(config_resolve, 2), rb_ary_entry(config_resolve, 3)), Qnil));
+  rb_funcall(rb_cFile, rb_intern("binwrite"), 2,
+    rb_ary_entry(config_resolve, 0), bin);
+
+  return Qnil;
+} /* }}} */
+
+/* RubyKeymap {{{ */
+static unsigned long long
+RubyKeymap(void)
+{
+  int i, min = 0, max = 0, per = 0;
+  unsigned long long hash = 14695981039346656037ULL;
+  KeySym *syms = NULL;
+
+  /* Hash keyboard mapping (FNV-1a) */
+  XDisplayKeycodes(subtle->dpy, &min, &max);
+
+  if((syms = XGetKeyboardMapping(subtle->dpy, min, max - min + 1, &per)))
+    {
+      for(i = 0; i < (max - min + 1) * per; i++)
+        {
+          hash ^= (unsigned long long)syms[i];
+          hash *= 1099511628211ULL;
+        }
+
+      XFree(syms);
+    }
+
+  return hash;
+} /* }}} */
+
+/* RubySnapshot {{{ */
+static VALUE
+RubySnapshot(VALUE str,
+  const char *path)
+{
+  int state = 0;
+  long i;
+  char buf[256] = { 0 }, dir[PATH_MAX] = { 0 }, file[PATH_MAX] = { 0 };
+  char *home = getenv("XDG_CACHE_HOME");
+  unsigned long long hash = 14695981039346656037ULL;
+  struct stat sb;
+  VALUE proc = Qnil, resolved = Qnil, rargs[4] = { Qnil };
+
+  if(-1 == stat(path, &sb)) return Qnil;
+
+  /* Hash config content (FNV-1a) */
+  for(i = 0; i < RSTRING_LEN(str); i++)
+    {
+      hash ^= (unsigned char)RSTRING_PTR(str)[i];
+      hash *= 1099511628211ULL;
+    }
+
+  /* Create cache dirs */
+  if(home) snprintf(dir, sizeof(dir), "%s", home);
+  else snprintf(dir, sizeof(dir), "%s/.cache", getenv("HOME"));
+
+  mkdir(dir, 0700);
+  strncat(dir, "/" PKG_NAME, sizeof(dir) - strlen(dir) - 1);
+  mkdir(dir, 0700);
+
+  /* Key: ruby version, path, mtime, size and hash */
+  snprintf(buf, sizeof(buf), "%s:%s:%s:%ld:%ld:%llx\n", PKG_NAME,
+    RUBY_VERSION, path, (long)sb.st_mtime, (long)sb.st_size, hash);
+
+  /* Load grabs and patterns resolved for this config and keymap */
+  if(!(subtle->flags & SUB_SUBTLE_CHECK))
+    {
+      snprintf(file, sizeof(file), "%s/config.resolve", dir);
+
+      rargs[0] = rb_str_new2(file);
+      rargs[1] = rb_str_new2(buf);
+
+      rb_str_catf(rargs[1], "%llx\n", RubyKeymap());
+
+      resolved = rb_protect(RubyWrapResolve, (VALUE)&rargs, &state);
+      if(state || T_ARRAY != rb_type(resolved) ||
+          T_HASH != rb_type(rb_ary_entry(resolved, 0)) ||
+          T_HASH != rb_type(rb_ary_entry(resolved, 1)))
+        {
+          rb_set_errinfo(Qnil);
+          state    = 0;
+          resolved = rb_ary_new3(2, rb_hash_new(), rb_hash_new());
+        }
+      else rb_ary_store(resolved, 2, Qtrue); ///< Mark as unchanged
+
+      config_resolve = rb_ary_new3(2, rargs[0], rargs[1]);
+      rb_ary_concat(config_resolve, resolved);
+    }
+
+  snprintf(file, sizeof(file), "%s/config.cache", dir);
+
+  rargs[0] = str;
+  rargs[1] = rb_str_new2(path);
+  rargs[2] = rb_str_new2(file);
+  rargs[3] = rb_str_new2(buf);
+
+  /* Fall back to plain eval on any error */
+  proc = rb_protect(RubyWrapCompile, (VALUE)&rargs, &state);
+  if(state)
+    {
+      subSharedLogDebugRuby("Snapshot failed=%s\n", file);
+      unlink(file);
+
+      rb_set_errinfo(Qnil);
+      proc = Qnil;
+    }
+
+  return proc;
+} /* }}} */
+
 /* RubyWrapSubletConfig {{{ */
 static VALUE
 RubyWrapSubletConfig(VALUE data)
@@ -1534,6 +2577,18 @@ RubyWrapSubletConfig(VALUE data)
           subStyleFind(&subtle->styles.sublets, RSTRING_PTR(value),
             &s->style);
         }
+
+      /* Run sublet in helper process */
+      value = rb_hash_lookup(hash, CHAR2SYM("process"));
+      if(Qtrue == value || FIXNUM_P(value))
+        {
+          s->flags   |= SUB_SUBLET_FORK;
+          s->timeout  = FIXNUM_P(value) ? FIX2INT(value) : 0;
+        }
+
+      /* Time budget in ms */
+      value = rb_hash_lookup(hash, CHAR2SYM("budget"));
+      if(FIXNUM_P(value)) s->budget = MAX(0, FIX2INT(value));
     }
 
   /* Check if there is a matching style */
@@ -1578,6 +2633,27 @@ RubyObjectDispatcher(VALUE self,
   return ret;
 } /* }}} */
 
+/* RubyObjectWatchdog {{{ */
+/*
+ * Signal handler to interrupt sublets - internal use only
+ */
+
+static VALUE
+RubyObjectWatchdog(int argc,
+  VALUE *argv,
+  VALUE self)
+{
+  /* Ruby runs the trap delayed, so skip signals of an earlier call */
+  if(watchdog && subSubtleClock(CLOCK_MONOTONIC) >= watchdog)
+    {
+      expired = True;
+
+      rb_raise(rb_eInterrupt, "Sublet exceeded time budget");
+    }
+
+  return Qnil;
+} /* }}} */
+
 /* Options */
 
 /* RubyOptionsInit {{{ */
@@ -1819,6 +2895,11 @@ RubyConfigSet(VALUE self,
                 if(!(subtle->flags & SUB_SUBTLE_CHECK))
                   subtle->gravity = value; ///< Store for later
               }
+            else if(CHAR2SYM("sublet_stats") == option)
+              {
+                if(!(subtle->flags & SUB_SUBTLE_CHECK))
+                  subtle->stats = MAX(0, FIX2INT(value));
+              }
             else subSharedLogWarn("Unknown option `:%s'\n", SYM2CHAR(option));
             break; /* }}} */
           case T_SYMBOL: /* {{{ */
@@ -1850,6 +2931,11 @@ RubyConfigSet(VALUE self,
                 if(!(subtle->flags & SUB_SUBTLE_CHECK) && Qtrue == value)
                   subtle->flags |= SUB_SUBTLE_TILING;
               }
+            else if(CHAR2SYM("opaque") == option)
+              {
+                if(!(subtle->flags & SUB_SUBTLE_CHECK) && Qtrue == value)
+                  subtle->flags |= SUB_SUBTLE_OPAQUE;
+              }
             else subSharedLogWarn("Unknown option `:%s'\n",
               SYM2CHAR(option));
             break; /* }}} */
@@ -2231,7 +3317,7 @@ RubyConfigView(int argc,
                   else
                     v->width += v->icon->width + 3;
 
-                  rb_ary_push(shelter, icon); ///< Protect from GC
+                  rb_hash_aset(shelter, icon, Qtrue); ///< Protect from GC
                 }
               else v->flags &= ~SUB_VIEW_ICON_ONLY;
             }
@@ -2361,13 +3447,13 @@ RubyConfigScreen(VALUE self,
               CHAR2SYM("top"))))
             {
               top = value; /// Lazy eval
-              rb_ary_push(shelter, value); ///< Protect from GC
+              rb_hash_aset(shelter, value, Qtrue); ///< Protect from GC
             }
           if(T_ARRAY == rb_type(value = rb_hash_lookup(params,
               CHAR2SYM("bottom"))))
             {
               bottom = value; ///< Lazy eval
-              rb_ary_push(shelter, value); ///< Protect from GC
+              rb_hash_aset(shelter, value, Qtrue); ///< Protect from GC
             }
           if(T_FIXNUM == rb_type(value = rb_hash_lookup(params,
               CHAR2SYM("view"))))
@@ -2659,7 +3745,7 @@ RubySubletOn(VALUE self,
           {
             { CHAR2SYM("run"),        CHAR2SYM("__run"),    SUB_SUBLET_RUN,    1 },
             { CHAR2SYM("data"),       CHAR2SYM("__data"),   SUB_SUBLET_DATA,   2 },
-            { CHAR2SYM("watch"),      CHAR2SYM("__watch"),  SUB_SUBLET_WATCH,  1 },
+            { CHAR2SYM("watch"),      CHAR2SYM("__watch"),  SUB_SUBLET_WATCH,  2 },
             { CHAR2SYM("unload"),     CHAR2SYM("__unload"), SUB_SUBLET_UNLOAD, 1 },
             { CHAR2SYM("mouse_down"), CHAR2SYM("__down"),   SUB_PANEL_DOWN,    4 },
             { CHAR2SYM("mouse_over"), CHAR2SYM("__over"),   SUB_PANEL_OVER,    1 },
@@ -2689,6 +3775,14 @@ RubySubletOn(VALUE self,
                       /* Create instance method from proc */
                       rb_funcall(sing, meth, 2, methods[i].real, proc);
 
+                      /* Cache arity for calls */
+                      if(SUB_SUBLET_DATA == methods[i].flags)
+                        p->sublet->darity = MINMAX(arity, 1, 2);
+                      else if(SUB_SUBLET_WATCH == methods[i].flags)
+                        p->sublet->warity = MINMAX(arity, 1, 2);
+                      else if(SUB_PANEL_DOWN == methods[i].flags)
+                        p->sublet->marity = MINMAX(arity, 1, 4);
+
                       return Qnil;
                     }
                   else rb_raise(rb_eArgError, "Wrong number of arguments (%d for %d)",
@@ -2754,7 +3848,7 @@ RubySubletGrab(VALUE self,
                   g->flags    ^= (SUB_RUBY_DATA|SUB_GRAB_PROC);
                   g->data.num  = (unsigned long)meth;
 
-                  rb_ary_push(shelter, meth); ///< Protect from GC
+                  rb_hash_aset(shelter, meth, Qtrue); ///< Protect from GC
                 }
             }
         }
@@ -2780,7 +3874,7 @@ RubySubletRender(VALUE self)
   SubPanel *p = NULL;
 
   Data_Get_Struct(self, SubPanel, p);
-  if(p) subScreenRender();
+  if(p && -1 == helper) subScreenRender();
 
   return Qnil;
 } /* }}} */
@@ -2848,10 +3942,15 @@ RubySubletIntervalWriter(VALUE self,
         {
           p->sublet->interval = FIX2INT(value);
           p->sublet->time     = subSubtleTime() + p->sublet->interval;
+          p->sublet->base     = 0; ///< Reset backoff
 
           if(0 < p->sublet->interval)
             p->sublet->flags |= SUB_SUBLET_INTERVAL;
           else p->sublet->flags &= ~SUB_SUBLET_INTERVAL;
+
+          /* Tell subtle about it */
+          if(-1 != helper)
+            RubyHelperSend(helper, HELPER_INTERVAL, p->sublet->interval, NULL, 0);
         }
       else rb_raise(rb_eArgError, "Unknown value type `%s'", rb_obj_classname(value));
     }
@@ -2915,16 +4014,15 @@ RubySubletDataWriter(VALUE self,
   if(p)
     {
       /* Check value type */
-      if(T_STRING == rb_type(value))
-        {
-          SubStyle *s = &subtle->styles.sublets, *style = NULL;
-
-          /* Select style */
-          if(s->styles && (style = subArrayGet(s->styles, p->sublet->style)))
-              s = style;
-
-          p->sublet->width = subSharedTextParse(subtle->dpy, subtle->font,
-            p->sublet->text, RSTRING_PTR(value)) + STYLE_WIDTH((*s));
+      if(T_STRING == rb_type(value))
+        {
+          /* Leave parsing to subtle when in helper */
+          if(-1 != helper)
+            {
+              RubyHelperSend(helper, HELPER_DATA, 0, RSTRING_PTR(value),
+                RSTRING_LEN(value) + 1);
+            }
+          else subPanelParse(p, RSTRING_PTR(value));
         }
       else rb_raise(rb_eArgError, "Unknown value type");
     }
@@ -3057,8 +4155,12 @@ RubySubletShow(VALUE self)
       p->flags &= ~SUB_PANEL_HIDDEN;
 
       /* Update screens */
-      subScreenUpdate();
-      subScreenRender();
+      if(-1 != helper) RubyHelperSend(helper, HELPER_SHOW, 0, NULL, 0);
+      else
+        {
+          subScreenUpdate();
+          subScreenRender();
+        }
     }
 
   return Qnil;
@@ -3086,8 +4188,12 @@ RubySubletHide(VALUE self,
       p->flags |= SUB_PANEL_HIDDEN;
 
       /* Update screens */
-      subScreenUpdate();
-      subScreenRender();
+      if(-1 != helper) RubyHelperSend(helper, HELPER_HIDE, 0, NULL, 0);
+      else
+        {
+          subScreenUpdate();
+          subScreenRender();
+        }
     }
 
   return Qnil;
@@ -3095,24 +4201,38 @@ RubySubletHide(VALUE self,
 
 /* RubySubletWatch {{{ */
 /*
- * call-seq: watch(source) -> true or false
+ * call-seq: watch(source, framing) -> true or false
  *
- * Add watch file via inotify or socket
+ * Add watch file via inotify or socket. With framing subtle reads the
+ * socket itself and passes the data to the watch block: Either all
+ * available data (:raw), each line (:lines) or each frame with a 32-bit
+ * big-endian length prefix (:length). The passed string is reused,
+ * dup it to keep it. On end of file or a frame larger than 1 MiB the
+ * socket is unwatched and the block is called with nil.
  *
  *  watch "/path/to/file"
  *  => true
  *
  *  @socket = TCPSocket("localhost", 6600)
  *  watch @socket
+ *
+ *  watch @socket, :lines
+ *
+ *  on :watch do |s, line|
+ *    s.data = line
+ *  end
  */
 
 static VALUE
-RubySubletWatch(VALUE self,
-  VALUE value)
+RubySubletWatch(int argc,
+  VALUE *argv,
+  VALUE self)
 {
-  VALUE ret = Qfalse;
+  VALUE ret = Qfalse, value = Qnil, framing = Qnil;
   SubPanel *p = NULL;
 
+  rb_scan_args(argc, argv, "11", &value, &framing);
+
   Data_Get_Struct(self, SubPanel, p);
   if(p)
     {
@@ -3126,6 +4246,19 @@ RubySubletWatch(VALUE self,
 
               p->sublet->flags |= SUB_SUBLET_SOCKET;
 
+              /* Let subtle read the socket */
+              if(!NIL_P(framing) && p->sublet->flags & SUB_SUBLET_FORK)
+                {
+                  subSharedLogWarn("Ignoring framing of sublet `%s' in "
+                    "helper process\n", p->sublet->name);
+                }
+              else if(CHAR2SYM("raw") == framing)
+                p->sublet->flags |= SUB_SUBLET_DRAIN;
+              else if(CHAR2SYM("lines") == framing)
+                p->sublet->flags |= SUB_SUBLET_LINES;
+              else if(CHAR2SYM("length") == framing)
+                p->sublet->flags |= SUB_SUBLET_FRAMES;
+
               /* Get socket file descriptor */
               if(FIXNUM_P(value)) p->sublet->watch = FIX2INT(value);
               else
@@ -3136,7 +4269,9 @@ RubySubletWatch(VALUE self,
 
               XSaveContext(subtle->dpy, subtle->windows.support,
                 p->sublet->watch, (void *)p);
-              subEventWatchAdd(p->sublet->watch);
+
+              if(!(p->sublet->flags & SUB_SUBLET_SUSPEND))
+                subEventWatchAdd(p->sublet->watch);
 
               /* Set nonblocking */
               if(-1 == (flags = fcntl(p->sublet->watch, F_GETFL, 0))) flags = 0;
@@ -3211,8 +4346,10 @@ RubySubletUnwatch(VALUE self)
           XDeleteContext(subtle->dpy, subtle->windows.support, p->sublet->watch);
           subEventWatchDel(p->sublet->watch);
 
-          p->sublet->flags &= ~SUB_SUBLET_SOCKET;
-          p->sublet->watch  = 0;
+          p->sublet->flags  &= ~(SUB_SUBLET_SOCKET|SUB_SUBLET_DRAIN|
+            SUB_SUBLET_LINES|SUB_SUBLET_FRAMES);
+          p->sublet->watch   = 0;
+          p->sublet->ninput  = 0;
 
           ret = Qtrue;
         }
@@ -3257,6 +4394,213 @@ RubySubletWarn(VALUE self,
   return Qnil;
 } /* }}} */
 
+/* Metrics */
+
+/* RubyMetricsCpu {{{ */
+/*
+ * call-seq: cpu -> Fixnum
+ *
+ * Get cpu usage in percent, sampled at most once per second
+ *
+ *  Subtle::Metrics.cpu
+ *  => 12
+ */
+
+static VALUE
+RubyMetricsCpu(VALUE self)
+{
+  return INT2FIX(subMetricsGet(SUB_METRICS_CPU)->cpu.usage);
+} /* }}} */
+
+/* RubyMetricsMemory {{{ */
+/*
+ * call-seq: memory -> Hash
+ *
+ * Get memory values in KiB, sampled at most once per second
+ *
+ *  Subtle::Metrics.memory
+ *  => { :total => 2048000, :free => 512000, :buffers => 1000,
+ *       :cached => 600000, :used => 935000 }
+ */
+
+static VALUE
+RubyMetricsMemory(VALUE self)
+{
+  VALUE hash = rb_hash_new();
+  SubMetrics *m = subMetricsGet(SUB_METRICS_MEMORY);
+
+  rb_hash_aset(hash, CHAR2SYM("total"),   ULONG2NUM(m->memory.total));
+  rb_hash_aset(hash, CHAR2SYM("free"),    ULONG2NUM(m->memory.free));
+  rb_hash_aset(hash, CHAR2SYM("buffers"), ULONG2NUM(m->memory.buffers));
+  rb_hash_aset(hash, CHAR2SYM("cached"),  ULONG2NUM(m->memory.cached));
+  rb_hash_aset(hash, CHAR2SYM("used"),    ULONG2NUM(m->memory.used));
+
+  return hash;
+} /* }}} */
+
+/* RubyMetricsNetwork {{{ */
+/*
+ * call-seq: network -> Hash
+ *
+ * Get network bytes and rates in bytes/s of all interfaces except
+ * loopback, sampled at most once per second
+ *
+ *  Subtle::Metrics.network
+ *  => { :rx => 1024000, :tx => 2048, :rx_rate => 512, :tx_rate => 0 }
+ */
+
+static VALUE
+RubyMetricsNetwork(VALUE self)
+{
+  VALUE hash = rb_hash_new();
+  SubMetrics *m = subMetricsGet(SUB_METRICS_NETWORK);
+
+  rb_hash_aset(hash, CHAR2SYM("rx"),      ULL2NUM(m->network.rx));
+  rb_hash_aset(hash, CHAR2SYM("tx"),      ULL2NUM(m->network.tx));
+  rb_hash_aset(hash, CHAR2SYM("rx_rate"), ULONG2NUM(m->network.rxrate));
+  rb_hash_aset(hash, CHAR2SYM("tx_rate"), ULONG2NUM(m->network.txrate));
+
+  return hash;
+} /* }}} */
+
+/* RubyMetricsBattery {{{ */
+/*
+ * call-seq: battery -> Hash or nil
+ *
+ * Get capacity in percent and state of first battery, sampled at most
+ * once per second
+ *
+ *  Subtle::Metrics.battery
+ *  => { :capacity => 80, :charging => false }
+ *
+ *  Subtle::Metrics.battery
+ *  => nil
+ */
+
+static VALUE
+RubyMetricsBattery(VALUE self)
+{
+  VALUE hash = Qnil;
+  SubMetrics *m = subMetricsGet(SUB_METRICS_BATTERY);
+
+  if(0 <= m->battery.capacity)
+    {
+      hash = rb_hash_new();
+
+      rb_hash_aset(hash, CHAR2SYM("capacity"), INT2FIX(m->battery.capacity));
+      rb_hash_aset(hash, CHAR2SYM("charging"),
+        m->battery.charging ? Qtrue : Qfalse);
+    }
+
+  return hash;
+} /* }}} */
+
+/* RubyCallName {{{ */
+static const char *
+RubyCallName(int type,
+  unsigned long proc,
+  const char **call)
+{
+  int i;
+  SubPanel *p = NULL;
+
+  /* Name sublet calls after sublet and hooks after event */
+  switch(type)
+    {
+      case SUB_CALL_RUN:    *call = "run";    break;
+      case SUB_CALL_DATA:   *call = "data";   break;
+      case SUB_CALL_WATCH:  *call = "watch";  break;
+      case SUB_CALL_DOWN:   *call = "down";   break;
+      case SUB_CALL_OVER:   *call = "over";   break;
+      case SUB_CALL_OUT:    *call = "out";    break;
+      case SUB_CALL_UNLOAD: *call = "unload"; break;
+      case SUB_CALL_EMIT:
+        for(i = 0; i < LENGTH(hooks); i++)
+          if(hooks[i].flags == (HOOK(proc)->flags & ~SUB_TYPE_HOOK))
+            return hooks[i].name;
+        return "hook";
+      case SUB_CALL_CONFIGURE: return "configure";
+      default: return "proc";
+    }
+
+  Data_Get_Struct(proc, SubPanel, p);
+
+  return p ? p->sublet->name : "sublet";
+} /* }}} */
+
+/* RubyCall {{{ */
+static int
+RubyCall(int type,
+  unsigned long proc,
+  void *data)
+{
+  int state = 0;
+  unsigned long long cpu = 0, wall = 0;
+  size_t allocs = 0;
+  VALUE rargs[3] = { Qnil };
+  SubPanel *p = NULL;
+
+  /* Pass sublet calls to helper */
+  if(-1 == helper && type & (SUB_CALL_RUN|SUB_CALL_DATA|SUB_CALL_WATCH|
+      SUB_CALL_DOWN|SUB_CALL_OVER|SUB_CALL_OUT|SUB_CALL_UNLOAD))
+    {
+      Data_Get_Struct(proc, SubPanel, p);
+      if(p && p->sublet->flags & SUB_SUBLET_FORK)
+        return RubyHelperCall(type, p, data);
+      else if(p && p->sublet->flags & SUB_SUBLET_HUNG)
+        return False;
+
+      /* Profile sublet calls */
+      if(p && type & (SUB_CALL_RUN|SUB_CALL_DATA|SUB_CALL_WATCH|
+          SUB_CALL_DOWN))
+        {
+          cpu    = subSubtleClock(CLOCK_THREAD_CPUTIME_ID);
+          wall   = subSubtleClock(CLOCK_MONOTONIC);
+          allocs = RubyAllocations();
+        }
+      else if(p && p->sublet->flags & SUB_SUBLET_NATIVE)
+        return subNativeCall(type, p);
+      else p = NULL;
+    }
+
+  if(p && p->sublet->flags & SUB_SUBLET_NATIVE)
+    state = !subNativeCall(type, p);
+  else
+    {
+      /* Wrap up data */
+      rargs[0] = (VALUE)type;
+      rargs[1] = proc;
+      rargs[2] = (VALUE)data;
+
+      /* Carefully call */
+      if(p && RubyWatchdogArm(p))
+        {
+          rb_protect(RubyWrapCall, (VALUE)&rargs, &state);
+          RubyWatchdogDisarm();
+        }
+      else rb_protect(RubyWrapCall, (VALUE)&rargs, &state);
+
+      if(state) RubyBacktrace();
+    }
+
+  if(p)
+    {
+      wall = subSubtleClock(CLOCK_MONOTONIC) - wall;
+
+      subPanelProfileCall(p, subSubtleClock(CLOCK_THREAD_CPUTIME_ID) - cpu,
+        wall, RubyAllocations() - allocs);
+
+      if(!(p->sublet->flags & SUB_SUBLET_NATIVE)) RubyBudget(type, p, wall);
+    }
+
+#ifdef DEBUG
+  subSharedLogDebugRuby("GC RUN\n");
+  rb_gc_start();
+#endif /* DEBUG */
+
+  return !state; ///< Reverse odd logic
+} /* }}} */
+
 /* Public */
 
  /** subRubyInit {{{
@@ -3266,7 +4610,7 @@ RubySubletWarn(VALUE self,
 void
 subRubyInit(void)
 {
-  VALUE config = Qnil, options = Qnil, sublet = Qnil;
+  VALUE config = Qnil, options = Qnil, sublet = Qnil, metrics = Qnil;
 
   RUBY_INIT_STACK;
   ruby_init();
@@ -3321,6 +4665,34 @@ subRubyInit(void)
 
   mod = rb_define_module("Subtle");
 
+  /* Intern ids for subtlext objects */
+  id_new      = rb_intern("new");
+  iv_win      = rb_intern("@win");
+  iv_flags    = rb_intern("@flags");
+  iv_name     = rb_intern("@name");
+  iv_instance = rb_intern("@instance");
+  iv_klass    = rb_intern("@klass");
+  iv_role     = rb_intern("@role");
+  iv_geometry = rb_intern("@geometry");
+  iv_gravity  = rb_intern("@gravity");
+  iv_screen   = rb_intern("@screen");
+  iv_id       = rb_intern("@id");
+  iv_x        = rb_intern("@x");
+  iv_y        = rb_intern("@y");
+  iv_width    = rb_intern("@width");
+  iv_height   = rb_intern("@height");
+
+  /* Intern ids for calls */
+  id_configure = rb_intern("__configure");
+  id_run       = rb_intern("__run");
+  id_data      = rb_intern("__data");
+  id_watch     = rb_intern("__watch");
+  id_down      = rb_intern("__down");
+  id_over      = rb_intern("__over");
+  id_out       = rb_intern("__out");
+  id_unload    = rb_intern("__unload");
+  id_call      = rb_intern("call");
+
   /*
    * Document-class: Config
    *
@@ -3389,13 +4761,35 @@ subRubyInit(void)
   rb_define_method(sublet, "show",           RubySubletShow,              0);
   rb_define_method(sublet, "style=",         RubySubletStyleWriter,       1);
   rb_define_method(sublet, "hide",           RubySubletHide,              0);
-  rb_define_method(sublet, "watch",          RubySubletWatch,             1);
+  rb_define_method(sublet, "watch",          RubySubletWatch,            -1);
   rb_define_method(sublet, "unwatch",        RubySubletUnwatch,           0);
   rb_define_method(sublet, "warn",           RubySubletWarn,              1);
 
+  /*
+   * Document-class: Subtle::Metrics
+   *
+   * Metrics module for shared system metrics
+   */
+
+  metrics = rb_define_module_under(mod, "Metrics");
+
+  /* Singleton methods */
+  rb_define_singleton_method(metrics, "cpu",     RubyMetricsCpu,     0);
+  rb_define_singleton_method(metrics, "memory",  RubyMetricsMemory,  0);
+  rb_define_singleton_method(metrics, "network", RubyMetricsNetwork, 0);
+  rb_define_singleton_method(metrics, "battery", RubyMetricsBattery, 0);
+
+  /* Interrupt sublets exceeding their time budget */
+  rb_define_singleton_method(mod, "__watchdog", RubyObjectWatchdog, -1);
+  rb_funcall(rb_const_get(rb_cObject, rb_intern("Signal")),
+    rb_intern("trap"), 2, rb_str_new2("ALRM"),
+    rb_obj_method(mod, CHAR2SYM("__watchdog")));
+
   /* Bypassing garbage collection */
-  shelter = rb_ary_new();
+  shelter = rb_hash_new();
+  rb_funcall(shelter, rb_intern("compare_by_identity"), 0, NULL);
   rb_gc_register_address(&shelter);
+  rb_gc_register_address(&config_resolve); ///< Only set during config load
 
   subSharedLogDebugSubtle("init=ruby\n");
 } /* }}} */
@@ -3412,7 +4806,7 @@ subRubyLoadConfig(void)
 {
   int state = 0;
   char buf[100] = { 0 }, path[100] = { 0 };
-  VALUE str = Qnil , klass = Qnil, rargs[3] = { Qnil };
+  VALUE str = Qnil , klass = Qnil, proc = Qnil, rargs[3] = { Qnil };
   SubTag *t = NULL;
 
   /* Check config paths */
@@ -3491,6 +4885,11 @@ subRubyLoadConfig(void)
   config_instance = rb_funcall(klass, rb_intern("new"), 0, NULL);
   rb_gc_register_address(&config_instance);
 
+  /* Use compiled snapshot if enabled */
+  if(subtle->flags & SUB_SUBTLE_CACHE &&
+      !NIL_P(proc = RubySnapshot(str, path)))
+    str = proc;
+
   /* Carefully eval file */
   rargs[0] = str;
   rargs[1] = rb_str_new2(path);
@@ -3515,6 +4914,24 @@ subRubyLoadConfig(void)
   /* If not check only lazy eval config values */
   if(!(subtle->flags & SUB_SUBTLE_CHECK)) RubyEvalConfig();
 
+  /* Store resolved grabs and patterns when changed */
+  if(!NIL_P(config_resolve))
+    {
+      if(!RTEST(rb_ary_entry(config_resolve, 4)))
+        {
+          rb_protect(RubyWrapResolveStore, Qnil, &state);
+          if(state)
+            {
+              subSharedLogDebugRuby("Resolve failed\n");
+
+              rb_set_errinfo(Qnil);
+              state = 0;
+            }
+        }
+
+      config_resolve = Qnil;
+    }
+
   /* Release methods list */
   rb_gc_unregister_address(&config_methods);
 
@@ -3538,7 +4955,8 @@ subRubyReloadConfig(void)
 
   /* Reset before reloading */
   subtle->flags &= (SUB_SUBTLE_DEBUG|SUB_SUBTLE_EWMH|SUB_SUBTLE_RUN|
-    SUB_SUBTLE_XINERAMA|SUB_SUBTLE_XRANDR|SUB_SUBTLE_URGENT);
+    SUB_SUBTLE_XINERAMA|SUB_SUBTLE_XRANDR|SUB_SUBTLE_URGENT|
+    SUB_SUBTLE_CACHE|SUB_SUBTLE_TRACE);
 
   /* Unregister config values */
   rb_gc_unregister_address(&config_sublets);
@@ -3670,7 +5088,7 @@ subRubyLoadSublet(const char *file)
   klass               = rb_const_get(mod, rb_intern("Sublet"));
   p->sublet->instance = Data_Wrap_Struct(klass, NULL, NULL, (void *)p);
 
-  rb_ary_push(shelter, p->sublet->instance); ///< Protect from GC
+  rb_hash_aset(shelter, p->sublet->instance, Qtrue); ///< Protect from GC
 
   /* Carefully eval file */
   rargs[0] = str;
@@ -3723,6 +5141,74 @@ subRubyLoadSublet(const char *file)
   printf("Loaded sublet (%s)\n", p->sublet->name);
 } /* }}} */
 
+ /** subRubyLoadNative {{{
+  * @brief Load native sublet
+  * @param[in]  name  Name of the native sublet
+  * @return Returns a #SubPanel or \p NULL
+  **/
+
+SubPanel *
+subRubyLoadNative(const char *name)
+{
+  int state = 0;
+  SubPanel *p = NULL;
+  SubNative *n = NULL;
+  VALUE klass = Qnil, rargs[2] = { Qnil };
+
+  /* Find builtin or plugin */
+  if(!(n = subNativeFind(name))) return NULL;
+
+  /* Create sublet */
+  p = subPanelNew(SUB_PANEL_SUBLET);
+  klass               = rb_const_get(mod, rb_intern("Sublet"));
+  p->sublet->name     = strdup(name);
+  p->sublet->native   = n;
+  p->sublet->flags   |= SUB_SUBLET_NATIVE;
+  p->sublet->instance = Data_Wrap_Struct(klass, NULL, NULL, (void *)p);
+
+  rb_hash_aset(shelter, p->sublet->instance, Qtrue); ///< Protect from GC
+
+  /* Carefully apply sublet config */
+  rargs[0] = CHAR2SYM(name);
+  rargs[1] = (VALUE)p->sublet;
+
+  rb_protect(RubyWrapSubletConfig, (VALUE)&rargs, &state);
+  if(state)
+    {
+      subSharedLogWarn("Failed configuring native sublet `%s'\n", name);
+      RubyBacktrace();
+    }
+
+  /* Init native */
+  if(!subNativeLoad(p))
+    {
+      subSharedLogWarn("Failed loading native sublet `%s'\n", name);
+
+      p->sublet->flags &= ~SUB_SUBLET_NATIVE;
+      subPanelKill(p);
+
+      return NULL;
+    }
+
+  /* Sanitize interval time */
+  if(0 >= p->sublet->interval)
+    p->sublet->interval = 0 < n->interval ? n->interval : 60;
+
+  if(p->sublet->flags & SUB_SUBLET_RUN)
+    {
+      p->sublet->flags |= SUB_SUBLET_INTERVAL;
+
+      /* First run */
+      subNativeCall(SUB_CALL_RUN, p);
+    }
+
+  subArrayPush(subtle->sublets, (void *)p);
+
+  printf("Loaded native sublet (%s)\n", p->sublet->name);
+
+  return p;
+} /* }}} */
+
  /** subRubyUnloadSublet {{{
   * @brief Unload sublets at runtime
   * @param[in]  p  A #SubPanel
@@ -3808,7 +5294,7 @@ void
 subRubyLoadSublets(void)
 {
   int i, num;
-  char buf[100];
+  char buf[100], name[100];
   struct dirent **entries = NULL;
 
 #ifdef HAVE_SYS_INOTIFY_H
@@ -3842,11 +5328,35 @@ subRubyLoadSublets(void)
   /* Scan directory */
   if(0 < ((num = scandir(buf, &entries, RubyFilter, alphasort))))
     {
+      int all = RubyPanelSymbol(CHAR2SYM("sublets"));
+
+      /* Load sublets used on panels only */
+      for(i = 0; i < num; i++)
+        {
+          snprintf(name, sizeof(name), "%.*s",
+            (int)strlen(entries[i]->d_name) - 3, entries[i]->d_name);
+
+          if(all || RubyPanelSymbol(CHAR2SYM(name)))
+            {
+              subRubyLoadSublet(entries[i]->d_name);
+
+              free(entries[i]);
+              entries[i] = NULL;
+            }
+          else subSharedLogDebugRuby("Skipped sublet=%s\n", name);
+        }
+
+      /* Load remaining sublets when file and sublet names differ */
+      all = RubyPanelMissing();
+
       for(i = 0; i < num; i++)
         {
-          subRubyLoadSublet(entries[i]->d_name);
+          if(entries[i])
+            {
+              if(all) subRubyLoadSublet(entries[i]->d_name);
 
-          free(entries[i]);
+              free(entries[i]);
+            }
         }
       free(entries);
 
@@ -3869,24 +5379,91 @@ subRubyCall(int type,
   unsigned long proc,
   void *data)
 {
+  int ret = 0;
+  char name[32] = { 0 };
+  const char *call = NULL;
+  unsigned long long start = subTraceStart();
+
+  /* Copy name before call, it might unload the sublet */
+  if(start)
+    snprintf(name, sizeof(name), "%s", RubyCallName(type, proc, &call));
+
+  ret = RubyCall(type, proc, data);
+
+  if(start)
+    subTraceSpan(call ? "sublet" : (SUB_CALL_EMIT == type ? "hook" : "ruby"),
+      name, call, start);
+
+  return ret;
+} /* }}} */
+
+ /** subRubyDefer {{{
+  * @brief Defer garbage collection while handling a burst of events
+  * @param[in]  defer  Whether to defer
+  **/
+
+void
+subRubyDefer(int defer)
+{
+  if(Qnil == shelter || defer == deferred) return;
+
+  /* Toggle GC */
+  if(defer) rb_gc_disable();
+  else rb_gc_enable();
+
+  deferred = defer;
+} /* }}} */
+
+ /** subRubyCollect {{{
+  * @brief Run minor garbage collection before going idle when enough
+  *        objects were allocated and no events are queued and publish
+  *        GC stats
+  **/
+
+void
+subRubyCollect(void)
+{
+#ifdef HAVE_RB_GC_STAT
   int state = 0;
-  VALUE rargs[3] = { Qnil };
+  size_t allocs = 0;
+  unsigned long wall = 0;
+  long stats[5] = { 0 };
+
+  if(Qnil == shelter || deferred) return;
+
+  /* Check allocations since last run */
+  if(GC_THRESHOLD > (allocs = RubyAllocations()) - collected) return;
 
-  /* Wrap up data */
-  rargs[0] = (VALUE)type;
-  rargs[1] = proc;
-  rargs[2] = (VALUE)data;
+  /* Pending events go first */
+  if(XEventsQueued(subtle->dpy, QueuedAfterReading)) return;
+
+  wall = subSubtleClock(CLOCK_MONOTONIC);
+  rb_protect(RubyWrapCollect, Qnil, &state);
+  wall = subSubtleClock(CLOCK_MONOTONIC) - wall;
 
-  /* Carefully call */
-  rb_protect(RubyWrapCall, (VALUE)&rargs, &state);
   if(state) RubyBacktrace();
 
-#ifdef DEBUG
-  subSharedLogDebugRuby("GC RUN\n");
-  rb_gc_start();
-#endif /* DEBUG */
+  /* Update profile */
+  gc.calls++;
+  gc.wall      += wall;
+  gc.max        = MAX(gc.max, wall);
+  gc.avgwall    = 1 == gc.calls ? wall : PROFILE_AVG(gc.avgwall, wall);
+  gc.avgallocs  = 1 == gc.calls ? allocs - collected :
+    PROFILE_AVG(gc.avgallocs, allocs - collected);
 
-  return !state; ///< Reverse odd logic
+  collected = allocs;
+
+  stats[0] = gc.calls;
+  stats[1] = gc.wall / 1000;
+  stats[2] = gc.avgwall;
+  stats[3] = gc.max;
+  stats[4] = gc.avgallocs;
+
+  /* EWMH: GC stats */
+  subEwmhSetCardinals(ROOT, SUB_EWMH_SUBTLE_GC_STATS, stats, LENGTH(stats));
+
+  subSharedLogDebugRuby("GC IDLE: wall=%luus, allocs=%ld\n", wall, stats[4]);
+#endif /* HAVE_RB_GC_STAT */
 } /* }}} */
 
  /** subRubyRelease {{{
@@ -3904,6 +5481,95 @@ subRubyRelease(unsigned long value)
   return state;
 } /* }}} */
 
+ /** subRubyHelperReceive {{{
+  * @brief Receive pending messages from sublet helper
+  * @param[in]  p  A #SubPanel
+  **/
+
+void
+subRubyHelperReceive(SubPanel *p)
+{
+  char *data = NULL;
+  RubyHelper msg;
+  struct pollfd pfd;
+
+  assert(p);
+
+  do
+    {
+      if(!RubyHelperRecv(p->sublet->helper, &msg, &data))
+        {
+          subSharedLogWarn("Lost helper of sublet `%s'\n", p->sublet->name);
+          subRubyHelperKill(p, True);
+
+          return;
+        }
+
+      /* Handle message type */
+      switch(msg.type)
+        {
+          case HELPER_DONE:
+            p->sublet->flags &= ~SUB_SUBLET_BUSY;
+            break;
+          case HELPER_DATA:
+            if(data) subPanelParse(p, data);
+            break;
+          case HELPER_INTERVAL:
+            p->sublet->interval = msg.value;
+            p->sublet->time     = subSubtleTime() + p->sublet->interval;
+
+            if(0 < p->sublet->interval)
+              p->sublet->flags |= SUB_SUBLET_INTERVAL;
+            else p->sublet->flags &= ~SUB_SUBLET_INTERVAL;
+
+            subArraySort(subtle->sublets, subPanelCompare);
+            break;
+          case HELPER_SHOW: p->flags &= ~SUB_PANEL_HIDDEN; break;
+          case HELPER_HIDE: p->flags |= SUB_PANEL_HIDDEN;  break;
+        }
+
+      if(data) free(data);
+
+      /* Check for more messages */
+      pfd.fd      = p->sublet->helper;
+      pfd.events  = POLLIN;
+      pfd.revents = 0;
+    } while(0 < poll(&pfd, 1, 0));
+} /* }}} */
+
+ /** subRubyHelperKill {{{
+  * @brief Stop sublet helper
+  * @param[in]  p      A #SubPanel
+  * @param[in]  force  Kill helper instead of waiting for it
+  **/
+
+void
+subRubyHelperKill(SubPanel *p,
+  int force)
+{
+  assert(p);
+
+  if(0 < p->sublet->pid)
+    {
+      /* Helper exits on closed socket */
+      if(force) kill(p->sublet->pid, SIGKILL);
+
+      XDeleteContext(subtle->dpy, subtle->windows.support,
+        p->sublet->helper);
+      subEventWatchDel(p->sublet->helper);
+      close(p->sublet->helper);
+
+      p->sublet->pid     = 0;
+      p->sublet->helper  = 0;
+      p->sublet->flags  &= ~SUB_SUBLET_BUSY;
+
+      /* Take socket watch back to spawn a new helper on data */
+      if(p->sublet->flags & SUB_SUBLET_SOCKET &&
+          !(p->sublet->flags & SUB_SUBLET_SUSPEND))
+        subEventWatchAdd(p->sublet->watch);
+    }
+} /* }}} */
+
  /** subRubyFinish {{{
   * @brief Finish ruby stack
   **/
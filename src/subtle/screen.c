@@ -59,8 +59,6 @@ ScreenPublish(void)
   free(panels);
   free(viewports);
 
-  XSync(subtle->dpy, False); ///< Sync all changes
-
   subSharedLogDebugSubtle("publish=screen, screens=%d\n",
     subtle->screens->ndata);
 } /* }}} */
@@ -172,12 +170,66 @@ subScreenInit(void)
 
   printf("Running on %d screen(s)\n", subtle->screens->ndata);
 
+  subScreenRate();
+
   ScreenPublish();
   subScreenPublish();
 
   subSharedLogDebugSubtle("init=screen\n");
 } /* }}} */
 
+ /** subScreenRate {{{
+  * @brief Update refresh rate of screens
+  **/
+
+void
+subScreenRate(void)
+{
+  subtle->rate = 0;
+
+#ifdef HAVE_X11_EXTENSIONS_XRANDR_H
+  if(subtle->flags & SUB_SUBTLE_XRANDR)
+    {
+      XRRScreenResources *res = NULL;
+
+      if((res = XRRGetScreenResourcesCurrent(subtle->dpy, ROOT)))
+        {
+          int i, j;
+          XRRCrtcInfo *crtc = NULL;
+
+          /* Use fastest mode of enabled crtcs */
+          for(i = 0; i < res->ncrtc; i++)
+            {
+              if((crtc = XRRGetCrtcInfo(subtle->dpy, res, res->crtcs[i])))
+                {
+                  for(j = 0; None != crtc->mode && j < res->nmode; j++)
+                    {
+                      XRRModeInfo *mode = &res->modes[j];
+                      unsigned long long dots = 0;
+
+                      if(mode->id != crtc->mode) continue;
+
+                      if(0 < (dots = (unsigned long long)mode->hTotal *
+                          mode->vTotal))
+                        {
+                          int rate = (int)((mode->dotClock + dots / 2) / dots);
+
+                          if(rate > subtle->rate) subtle->rate = rate;
+                        }
+                    }
+
+                  XRRFreeCrtcInfo(crtc);
+                }
+            }
+
+          XRRFreeScreenResources(res);
+        }
+    }
+#endif /* HAVE_X11_EXTENSIONS_XRANDR_H */
+
+  subSharedLogDebugSubtle("rate=%d\n", subtle->rate);
+} /* }}} */
+
  /** subScreenNew {{{
   * @brief Create a new view
   * @param[in]  x       X position of screen
@@ -306,6 +358,10 @@ subScreenConfigure(void)
   int i;
   SubScreen *s = NULL;
   SubView *v = NULL;
+  SubAccount mark;
+  unsigned long long start = subTraceStart();
+
+  subDisplayMark(&mark);
 
   /* Reset visible tags, views and avaiclients */
   subtle->visible_tags  = 0;
@@ -399,11 +455,12 @@ subScreenConfigure(void)
   subEwmhSetCardinals(ROOT, SUB_EWMH_SUBTLE_VISIBLE_VIEWS,
     (long *)&subtle->visible_views, 1);
 
-  XSync(subtle->dpy, False); ///< Sync before going on
-
   /* Hook: Configure */
   subHookCall(SUB_HOOK_TILE, NULL);
 
+  subDisplayAccount(SUB_ACCOUNT_SCREEN_CONFIGURE, &mark);
+  subTraceSpan("screen", "configure", NULL, start);
+
   subSharedLogDebugSubtle("Configure: type=screen\n");
 } /* }}} */
 
@@ -415,6 +472,7 @@ void
 subScreenUpdate(void)
 {
   int i;
+  unsigned long long start = subTraceStart();
 
   /* Update screens */
   for(i = 0; i < subtle->screens->ndata; i++)
@@ -526,6 +584,8 @@ subScreenUpdate(void)
           x[offset] += p->width;
         }
     }
+
+  subTraceSpan("screen", "update", NULL, start);
 } /* }}} */
 
  /** subScreenRender {{{
@@ -536,6 +596,10 @@ void
 subScreenRender(void)
 {
   int i, j;
+  SubAccount mark;
+  unsigned long long start = subTraceStart();
+
+  subDisplayMark(&mark);
 
   /* Render all screens */
   for(i = 0; i < subtle->screens->ndata; i++)
@@ -564,7 +628,8 @@ subScreenRender(void)
       ScreenCopy(s, panel);
     }
 
-  XSync(subtle->dpy, False); ///< Sync before going on
+  subDisplayAccount(SUB_ACCOUNT_SCREEN_RENDER, &mark);
+  subTraceSpan("screen", "render", NULL, start);
 } /* }}} */
 
  /** subScreenResize {{{
@@ -669,6 +734,9 @@ subScreenKill(SubScreen *s)
   /* Destroy drawable */
   if(s->drawable) XFreePixmap(subtle->dpy, s->drawable);
 
+  /* Release ruby object */
+  if(s->object) subRubyRelease(s->object);
+
   free(s);
 
   subSharedLogDebugSubtle("kill=screen\n");
@@ -701,8 +769,6 @@ subScreenPublish(void)
 
   free(views);
 
-  XSync(subtle->dpy, False); ///< Sync all changes
-
   subSharedLogDebugSubtle("publish=screen, screens=%d\n",
     subtle->screens->ndata);
 } /* }}} */
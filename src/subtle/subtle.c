@@ -32,6 +32,7 @@ SubtleSignal(int signum)
       case SIGCHLD: wait(NULL);                                    break;
       case SIGHUP:  if(subtle) subtle->flags |= SUB_SUBTLE_RELOAD; break;
       case SIGINT:  if(subtle) subtle->flags &= ~SUB_SUBTLE_RUN;   break;
+      case SIGUSR1: if(subtle) subtle->flags |= SUB_SUBTLE_TRACE;  break;
       case SIGSEGV:
           {
 #ifdef HAVE_EXECINFO_H
@@ -64,12 +65,15 @@ SubtleUsage(void)
   printf("Usage: %s [OPTIONS]\n\n" \
          "Options:\n" \
          "  -c, --config=FILE       Load config\n" \
+         "  -C, --cache             Cache compiled config\n" \
          "  -d, --display=DISPLAY   Connect to DISPLAY\n" \
          "  -h, --help              Show this help and exit\n" \
          "  -k, --check             Check config syntax\n" \
          "  -n, --no-randr          Disable RandR extension (required for Twinview)\n" \
          "  -r, --replace           Replace current window manager\n" \
          "  -s, --sublets=DIR       Load sublets from DIR\n" \
+         "  -S, --socket=PATH       Serve control socket at PATH\n" \
+         "  -t, --trace=FILE        Trace event loop into FILE (toggle: SIGUSR1)\n" \
          "  -v, --version           Show version info and exit\n" \
          "  -l, --level             Set logging level\n" \
          "  -D, --debug             Print debugging messages\n" \
@@ -164,6 +168,22 @@ subSubtleTime(void)
   return tv.tv_sec;
 } /* }}} */
 
+ /** subSubtleClock {{{
+  * @brief Get the current value of a clock in microseconds
+  * @param[in]  clock  Clock id
+  * @return Returns time in microseconds
+  **/
+
+unsigned long long
+subSubtleClock(clockid_t clock)
+{
+  struct timespec ts = { 0 };
+
+  clock_gettime(clock, &ts);
+
+  return (unsigned long long)ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+} /* }}} */
+
  /** subSubtleFocus {{{
   * @brief Get pointer window and focus it
   * @param[in]  focus  Focus next client
@@ -236,6 +256,18 @@ subSubtleFocus(int focus)
   return ROOT;
 } /* }}} */
 
+ /** subSubtleSync {{{
+  * @brief Wait until the server processed all requests
+  **/
+
+void
+subSubtleSync(void)
+{
+  XSync(subtle->dpy, False);
+
+  subtle->syncs++;
+} /* }}} */
+
  /** subSubtleFinish {{{
   * @brief Finish subtle
   **/
@@ -281,7 +313,11 @@ subSubtleFinish(void)
       if(subtle->styles.subtle.styles)
         subArrayKill(subtle->styles.subtle.styles,    True);
 
+      subControlFinish();
+      subTraceFinish();
+      subLatencyFinish();
       subEventFinish();
+      subNativeFinish();
       subRubyFinish();
       subEwmhFinish();
       subDisplayFinish();
@@ -303,12 +339,15 @@ main(int argc,
   const struct option long_options[] =
   {
     { "config",   required_argument, 0, 'c' },
+    { "cache",    no_argument,       0, 'C' },
     { "display",  required_argument, 0, 'd' },
     { "help",     no_argument,       0, 'h' },
     { "check",    no_argument,       0, 'k' },
     { "no-randr", no_argument,       0, 'n' },
     { "replace",  no_argument,       0, 'r' },
     { "sublets",  required_argument, 0, 's' },
+    { "socket",   required_argument, 0, 'S' },
+    { "trace",    required_argument, 0, 't' },
     { "version",  no_argument,       0, 'v' },
 #ifdef DEBUG
     { "level",    required_argument, 0, 'l' },
@@ -322,17 +361,23 @@ main(int argc,
   subtle->flags |= (SUB_SUBTLE_XRANDR|SUB_SUBTLE_XINERAMA);
 
   /* Parse arguments */
-  while(-1 != (c = getopt_long(argc, argv, "c:d:hknrs:vl:D", long_options, NULL)))
+  while(-1 != (c = getopt_long(argc, argv, "c:Cd:hknrs:S:t:vl:D", long_options, NULL)))
     {
       switch(c)
         {
           case 'c': subtle->paths.config = optarg;        break;
+          case 'C': subtle->flags |= SUB_SUBTLE_CACHE;    break;
           case 'd': display = optarg;                     break;
           case 'h': SubtleUsage();                        return 0;
           case 'k': subtle->flags |= SUB_SUBTLE_CHECK;    break;
           case 'n': subtle->flags &= ~SUB_SUBTLE_XRANDR;  break;
           case 'r': subtle->flags |= SUB_SUBTLE_REPLACE;  break;
           case 's': subtle->paths.sublets = optarg;       break;
+          case 'S': subtle->paths.socket  = optarg;       break;
+          case 't':
+            subtle->paths.trace = optarg;
+            subtle->flags      |= SUB_SUBTLE_TRACE;
+            break;
           case 'v': SubtleVersion();                      return 0;
 #ifdef DEBUG
           case 'l':
@@ -364,6 +409,7 @@ main(int argc,
   sigaction(SIGINT,  &sa, NULL);
   sigaction(SIGSEGV, &sa, NULL);
   sigaction(SIGCHLD, &sa, NULL);
+  sigaction(SIGUSR1, &sa, NULL);
 
   /* Load and check config only */
   if(subtle->flags & SUB_SUBTLE_CHECK)
@@ -409,6 +455,7 @@ main(int argc,
   /* Display */
   subDisplayConfigure();
   subDisplayScan();
+  subControlInit();
 
   subEventLoop();
 
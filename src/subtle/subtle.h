@@ -19,12 +19,14 @@
 #include <string.h>
 #include <errno.h>
 #include <assert.h>
+#include <time.h>
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xmd.h>
 
 #include "config.h"
 #include "shared.h"
+#include "native.h"
 
 #ifdef HAVE_SYS_INOTIFY_H
 #include <sys/inotify.h>
@@ -81,6 +83,8 @@
 #define MINMAX(val,min,max) \
   ((val < min) ? min : ((val > max) ? max : val))                 ///< Value min/max
 
+#define PROFILE_AVG(avg,val) (((avg) * 7 + (val)) / 8)            ///< Profile rolling average
+
 #define XYINRECT(wx,wy,r) \
   (wx >= r.x && wx <= (r.x + r.width) && \
    wy >= r.y && wy <= (r.y + r.height))                           ///< Whether x/y is in rect
@@ -148,6 +152,7 @@
 #define SUB_CALL_OVER                 (1L << 16)                  ///< Call mouse over hook
 #define SUB_CALL_OUT                  (1L << 17)                  ///< Call mouse out hook
 #define SUB_CALL_UNLOAD               (1L << 18)                  ///< Call unload hook
+#define SUB_CALL_EMIT                 (1L << 19)                  ///< Call cached hook
 
 /* Hook flags */
 #define SUB_HOOK_START                (1L << 10)                  ///< Start hook
@@ -261,6 +266,15 @@
 #define SUB_SUBLET_DATA               (1L << 14)                  ///< Sublet data function
 #define SUB_SUBLET_WATCH              (1L << 15)                  ///< Sublet watch function
 #define SUB_SUBLET_UNLOAD             (1L << 16)                  ///< Sublet unload function
+#define SUB_SUBLET_FORK               (1L << 17)                  ///< Sublet runs in helper process
+#define SUB_SUBLET_BUSY               (1L << 18)                  ///< Sublet helper is busy
+#define SUB_SUBLET_NATIVE             (1L << 19)                  ///< Sublet is native
+#define SUB_SUBLET_PARSED             (1L << 20)                  ///< Sublet data parsed since render
+#define SUB_SUBLET_HUNG               (1L << 21)                  ///< Sublet hung too often
+#define SUB_SUBLET_SUSPEND            (1L << 22)                  ///< Sublet suspended while hidden
+#define SUB_SUBLET_DRAIN              (1L << 23)                  ///< Sublet socket read by subtle
+#define SUB_SUBLET_LINES              (1L << 24)                  ///< Sublet socket split in lines
+#define SUB_SUBLET_FRAMES             (1L << 25)                  ///< Sublet socket length prefixed
 
 /* Screen flags */
 #define SUB_SCREEN_PANEL1             (1L << 10)                  ///< Panel1 enabled
@@ -281,6 +295,9 @@
 #define SUB_SUBTLE_RELOAD             (1L << 10)                  ///< Reload config
 #define SUB_SUBTLE_TRAY               (1L << 11)                  ///< Use tray
 #define SUB_SUBTLE_TILING             (1L << 12)                  ///< Enable tiling
+#define SUB_SUBTLE_CACHE              (1L << 13)                  ///< Cache compiled config
+#define SUB_SUBTLE_OPAQUE             (1L << 14)                  ///< Opaque move/resize
+#define SUB_SUBTLE_TRACE              (1L << 15)                  ///< Toggle tracing
 
 /* Tag flags */
 #define SUB_TAG_GRAVITY               (1L << 10)                  ///< Gravity property
@@ -388,7 +405,9 @@ typedef struct subclient_t /* {{{ */
   float      minr, maxr;                                          ///< Client ratios
   int        minw, minh, maxw, maxh, incw, inch, basew, baseh;    ///< Client sizes
 
-  int        dir, screen, gravity, *gravities;                    ///< Client placement
+  int        screen, gravity, *gravities;                         ///< Client placement
+
+  unsigned long object;                                           ///< Client ruby object
 } SubClient; /* }}} */
 
 typedef enum subewmh_t /* {{{ */
@@ -480,10 +499,15 @@ typedef enum subewmh_t /* {{{ */
   SUB_EWMH_SUBTLE_SUBLET_NEW,                                     ///< Subtle sublet new
   SUB_EWMH_SUBTLE_SUBLET_UPDATE,                                  ///< Subtle sublet update
   SUB_EWMH_SUBTLE_SUBLET_DATA,                                    ///< Subtle sublet data
+  SUB_EWMH_SUBTLE_SUBLET_BATCH,                                   ///< Subtle sublet batch data
   SUB_EWMH_SUBTLE_SUBLET_STYLE,                                   ///< Subtle sublet style
   SUB_EWMH_SUBTLE_SUBLET_FLAGS,                                   ///< Subtle sublet flags
   SUB_EWMH_SUBTLE_SUBLET_LIST,                                    ///< Subtle sublet list
   SUB_EWMH_SUBTLE_SUBLET_KILL,                                    ///< Subtle sublet kill
+  SUB_EWMH_SUBTLE_SUBLET_STATS,                                   ///< Subtle sublet stats
+  SUB_EWMH_SUBTLE_GC_STATS,                                       ///< Subtle GC stats
+  SUB_EWMH_SUBTLE_X_STATS,                                        ///< Subtle X request stats
+  SUB_EWMH_SUBTLE_LATENCY_STATS,                                  ///< Subtle latency stats
   SUB_EWMH_SUBTLE_SCREEN_PANELS,                                  ///< Subtle screen panels
   SUB_EWMH_SUBTLE_SCREEN_VIEWS,                                   ///< Subtle screen views
   SUB_EWMH_SUBTLE_SCREEN_JUMP,                                    ///< Subtle screen jump
@@ -500,6 +524,36 @@ typedef enum subewmh_t /* {{{ */
   SUB_EWMH_TOTAL
 } SubEwmh; /* }}} */
 
+typedef enum subaccountid_t /* {{{ */
+{
+  /* Event handlers */
+  SUB_ACCOUNT_COLORMAP,                                           ///< Account colormap notify
+  SUB_ACCOUNT_CONFIGURE,                                          ///< Account configure notify
+  SUB_ACCOUNT_CONFIGURE_REQUEST,                                  ///< Account configure request
+  SUB_ACCOUNT_CROSSING,                                           ///< Account enter/leave notify
+  SUB_ACCOUNT_DESTROY,                                            ///< Account destroy notify
+  SUB_ACCOUNT_EXPOSE,                                             ///< Account expose
+  SUB_ACCOUNT_FOCUS,                                              ///< Account focus in
+  SUB_ACCOUNT_GRAB,                                               ///< Account key/button press
+  SUB_ACCOUNT_MAP,                                                ///< Account map notify
+  SUB_ACCOUNT_MAP_REQUEST,                                        ///< Account map request
+  SUB_ACCOUNT_MESSAGE,                                            ///< Account client message
+  SUB_ACCOUNT_PROPERTY,                                           ///< Account property notify
+  SUB_ACCOUNT_SELECTION,                                          ///< Account selection clear
+  SUB_ACCOUNT_UNMAP,                                              ///< Account unmap notify
+
+  /* Operations */
+  SUB_ACCOUNT_SCREEN_CONFIGURE,                                   ///< Account subScreenConfigure
+  SUB_ACCOUNT_SCREEN_RENDER,                                      ///< Account subScreenRender
+  SUB_ACCOUNT_CLIENT_NEW,                                         ///< Account subClientNew
+  SUB_ACCOUNT_CLIENT_FOCUS,                                       ///< Account subClientFocus
+  SUB_ACCOUNT_CLIENT_RETAG,                                       ///< Account subClientRetag
+  SUB_ACCOUNT_VIEW_SWITCH,                                        ///< Account subViewSwitch
+  SUB_ACCOUNT_RELOAD,                                             ///< Account config reload
+
+  SUB_ACCOUNT_TOTAL
+} SubAccountId; /* }}} */
+
 typedef struct subgrab_t /* {{{ */
 {
   FLAGS              flags;                                    ///< Grab flags
@@ -521,7 +575,8 @@ typedef struct subgravity_t /* {{{ */
 typedef struct subhook_t /* {{{ */
 {
   FLAGS         flags;                                            ///< Hook flags
-  unsigned long proc;                                             ///< Hook proc
+  unsigned long proc, receiver;                                   ///< Hook proc and receiver
+  int           arity;                                            ///< Hook arity
 } SubHook; /* }}} */
 
 typedef struct subicon_t /* {{{ */
@@ -556,8 +611,21 @@ typedef struct subscreen_t /* {{{ */
 
   /* FIXME: Cache ruby object during config */
   unsigned long     top, bottom;                                  ///< Screen panel values
+  unsigned long     object;                                       ///< Screen ruby object
 } SubScreen; /* }}} */
 
+typedef struct subprofile_t /* {{{ */
+{
+  unsigned long      calls, max;                                  ///< Profile calls and max wall time
+  unsigned long long cpu, wall, render, allocs;                   ///< Profile totals, times in usec
+  unsigned long      avgcpu, avgwall, avgrender, avgallocs;       ///< Profile rolling averages
+} SubProfile; /* }}} */
+
+typedef struct subaccount_t /* {{{ */
+{
+  unsigned long calls, requests, roundtrips, max;                 ///< Account calls, X requests, round trips and max requests per call
+} SubAccount; /* }}} */
+
 typedef struct subsublet_t { /* {{{ */
   FLAGS             flags;                                        ///< Sublet flags
   int               watch, width, style;                          ///< Sublet watch id, width and style state
@@ -565,6 +633,24 @@ typedef struct subsublet_t { /* {{{ */
   unsigned long     instance;                                     ///< Sublet ruby instance, fg, bg and icon color
   time_t            time, interval;                               ///< Sublet update/interval time
 
+  pid_t             pid;                                          ///< Sublet helper pid
+  int               helper;                                       ///< Sublet helper socket
+  time_t            timeout;                                      ///< Sublet helper timeout
+  unsigned long long deadline;                                    ///< Sublet helper deadline in usec
+
+  int               budget, hangs;                                ///< Sublet time budget in ms and hangs
+  int               darity, marity, warity;                       ///< Sublet data, mouse down and watch arity
+  time_t            base;                                         ///< Sublet interval before backoff
+
+  struct subnative_t *native;                                     ///< Sublet native callbacks
+  void              *data;                                        ///< Sublet native data
+  char              *buffer;                                      ///< Sublet native text buffer
+
+  char              *input;                                       ///< Sublet socket input buffer
+  size_t            ninput, sinput;                               ///< Sublet socket input length and size
+  unsigned long     chunk;                                        ///< Sublet socket ruby string
+
+  struct subprofile_t profile;                                    ///< Sublet profile
   struct subtext_t  *text;                                        ///< Sublet text
 } SubSublet; /* }}} */
 
@@ -589,9 +675,12 @@ typedef struct subsubtle_t /* {{{ */
 
   int                  width, height;                             ///< Subtle screen size
   int                  ph, step, snap;                            ///< Subtle properties
+  int                  rate;                                      ///< Subtle refresh rate in Hz
+  int                  stats;                                     ///< Subtle sublet stats log interval
   int                  visible_tags, visible_views;               ///< Subtle visible tags and views
   int                  client_tags, urgent_tags;                  ///< Subtle clients and urgent tags
   unsigned long        gravity;                                   ///< Subtle gravity
+  unsigned long        syncs;                                     ///< Subtle XSync counter
 
   Display              *dpy;                                      ///< Subtle Xorg display
 
@@ -620,7 +709,7 @@ typedef struct subsubtle_t /* {{{ */
 
   struct
   {
-    char               *config, *sublets;                         ///< Subtle paths
+    char               *config, *sublets, *socket, *trace;        ///< Subtle paths
   } paths;
 
   struct
@@ -658,6 +747,7 @@ typedef struct subtag_t /* {{{ */
   unsigned long     gravity;                                      ///< Tag gravity
   XRectangle        geom;                                         ///< Tag geometry
   struct subarray_t *matcher;                                     ///< Tag matcher
+  unsigned long     object;                                       ///< Tag ruby object
 } SubTag; /* }}} */
 
 typedef struct subtray_t /* {{{ */
@@ -678,6 +768,7 @@ typedef struct subview_t /* {{{ */
   int               width, style;                                 ///< View width, style state
 
   struct subicon_t  *icon;                                        ///< View icon
+  unsigned long     object;                                       ///< View ruby object
 } SubView; /* }}} */
 
 extern SubSubtle *subtle;
@@ -723,7 +814,14 @@ void subClientSetTransient(SubClient *c, int *flags);             ///< Set clien
 void subClientSetType(SubClient *c, int *flags);                  ///< Set client type
 void subClientClose(SubClient *c);                                ///< Close client
 void subClientKill(SubClient *c);                                 ///< Kill client
-void subClientPublish(int restack);                               ///< Publish all clients
+void subClientPublish(SubClient *c, int added);                  ///< Publish client list
+void subClientPublishStacking(void);                              ///< Publish stacking list
+/* }}} */
+
+/* control.c {{{ */
+void subControlInit(void);                                        ///< Open control socket
+int subControlHandle(int fd);                                     ///< Handle control socket
+void subControlFinish(void);                                      ///< Close control socket
 /* }}} */
 
 /* display.c {{{ */
@@ -732,11 +830,19 @@ void subDisplayConfigure(void);                                   ///< Configure
 void subDisplayScan(void);                                        ///< Scan root window
 void subDisplayPublish(void);                                     ///< Publish colors
 void subDisplayFinish(void);                                      ///< Kill display
+void subDisplayMark(SubAccount *mark);                            ///< Mark X request counters
+void subDisplayAccount(SubAccountId id, SubAccount *mark);        ///< Account X requests since mark
+void subDisplayAccountPublish(void);                              ///< Publish X request stats
 /* }}} */
 
 /* event.c {{{ */
+int subEventMatch(int type, XRectangle *origin,
+  XRectangle *test);                                              ///< Get directional distance
+int subEventCoalesce(XEvent *events, int nevents);                ///< Drop superseded events
+void subEventMessage(XClientMessageEvent *ev);                    ///< Handle client message
 void subEventWatchAdd(int fd);                                    ///< Add watch fd
 void subEventWatchDel(int fd);                                    ///< Del watch fd
+void subEventWatchEvents(int fd, short events);                   ///< Set watch events
 void subEventLoop(void);                                          ///< Event loop
 void subEventFinish(void);                                        ///< Finish events
 /* }}} */
@@ -765,6 +871,8 @@ void subEwmhFinish(void);                                         ///< Unset EWM
 /* grab.c {{{ */
 void subGrabInit(void);                                           ///< Init keymap
 SubGrab *subGrabNew(const char *keys, int *duplicate);            ///< Create grab
+SubGrab *subGrabNewCode(unsigned int code, unsigned int state,
+  int mouse, int *duplicate);                                     ///< Create grab from code
 SubGrab *subGrabFind(int code, unsigned int mod);                 ///< Find grab
 void subGrabSet(Window win);                                      ///< Grab window
 void subGrabUnset(Window win);                                    ///< Ungrab window
@@ -788,14 +896,33 @@ void subHookCall(int type, void *data);                           ///< Call hook
 void subHookKill(SubHook *h);                                     ///< Kill hook
 /* }}} */
 
+/* latency.c {{{ */
+void subLatencyRecord(XEvent *ev, unsigned long long start);     ///< Record event latency
+void subLatencyPublish(void);                                     ///< Publish latency stats
+void subLatencyFinish(void);                                      ///< Free histograms
+/* }}} */
+
+/* native.c {{{ */
+SubNative *subNativeFind(const char *name);                       ///< Find native sublet
+int subNativeLoad(SubPanel *p);                                   ///< Load native sublet
+int subNativeCall(int type, SubPanel *p);                         ///< Call native sublet
+void subNativeKill(SubPanel *p);                                  ///< Kill native sublet
+void subNativeFinish(void);                                       ///< Unload native plugins
+/* }}} */
+
 /* panel.c {{{ */
 SubPanel *subPanelNew(int type);                                  ///< Create new panel
 void subPanelUpdate(SubPanel *p);                                 ///< Update panels
+void subPanelParse(SubPanel *p, char *data);                      ///< Parse sublet data
 void subPanelRender(SubPanel *p, Drawable drawable);              ///< Render panels
 int subPanelCompare(const void *a, const void *b);                ///< Compare two panels
 void subPanelAction(SubArray *panels, int type, int x, int y,
   int button, int bottom);                                        ///< Handle panel action
 void subPanelPublish(void);                                       ///< Publish sublets
+void subPanelProfileCall(SubPanel *p, unsigned long cpu,
+  unsigned long wall, unsigned long allocs);                      ///< Profile sublet call
+void subPanelProfileRender(unsigned long render);                 ///< Profile render
+void subPanelProfilePublish(void);                                ///< Publish sublet stats
 void subPanelKill(SubPanel *p);                                   ///< Kill panel
 /* }}} */
 
@@ -804,16 +931,22 @@ void subRubyInit(void);                                           ///< Init Ruby
 int subRubyLoadConfig(void);                                      ///< Load config file
 void subRubyReloadConfig(void);                                   ///< Reload config file
 void subRubyLoadSublet(const char *file);                         ///< Load sublet
+SubPanel *subRubyLoadNative(const char *name);                    ///< Load native sublet
 void subRubyUnloadSublet(SubPanel *p);                            ///< Unload sublet
 void subRubyLoadSublets(void);                                    ///< Load sublets
 void subRubyLoadPanels(void);                                     ///< Load panels
 int subRubyCall(int type, unsigned long proc, void *data);        ///< Call Ruby script
 int subRubyRelease(unsigned long recv);                           ///< Release receiver
+void subRubyDefer(int defer);                                     ///< Defer Ruby GC
+void subRubyCollect(void);                                        ///< Run Ruby GC when idle
+void subRubyHelperReceive(SubPanel *p);                           ///< Receive helper messages
+void subRubyHelperKill(SubPanel *p, int force);                   ///< Kill sublet helper
 void subRubyFinish(void);                                         ///< Kill Ruby stack
 /* }}} */
 
 /* screen.c {{{ */
 void subScreenInit(void);                                         ///< Init screens
+void subScreenRate(void);                                         ///< Update refresh rate
 SubScreen *subScreenNew(int x, int y, unsigned int width,
   unsigned int height);                                           ///< Create screen
 SubScreen *subScreenFind(int x, int y, int *sid);                 ///< Find screen by coordinates
@@ -839,19 +972,29 @@ void subStyleInheritance(void);                                   ///< Inherit v
 /* subtle.c {{{ */
 XPointer * subSubtleFind(Window win, XContext id);                ///< Find window
 time_t subSubtleTime(void);                                       ///< Get current time
+unsigned long long subSubtleClock(clockid_t clock);               ///< Get clock in usec
 Window subSubtleFocus(int focus);                                 ///< Focus window
+void subSubtleSync(void);                                         ///< Sync with server
 void subSubtleFinish(void);                                       ///< Finish subtle
 /* }}} */
 
 /* tag.c {{{ */
 SubTag *subTagNew(char *name, int *duplicate);                    ///< Create tag
-void subTagMatcherAdd(SubTag *t, int type,
-  char *pattern, int and);                                        ///< Add a matcher
+int subTagMatcherAdd(SubTag *t, int type,
+  char *pattern, int and, int defer);                             ///< Add a matcher
 int subTagMatcherCheck(SubTag *t, SubClient *c);                  ///< Check for match
 void subTagPublish(void);                                         ///< Publish tags
 void subTagKill(SubTag *t);                                       ///< Delete tag
 /* }}} */
 
+/* trace.c {{{ */
+unsigned long long subTraceStart(void);                           ///< Get span start
+void subTraceSpan(const char *cat, const char *name,
+  const char *call, unsigned long long start);                    ///< Record span
+void subTraceToggle(void);                                        ///< Toggle tracing
+void subTraceFinish(void);                                        ///< Finish tracing
+/* }}} */
+
 /* tray.c {{{ */
 SubTray *subTrayNew(Window win);                                  ///< Create tray
 void subTrayConfigure(SubTray *t);                                ///< Configure tray
@@ -20,6 +20,7 @@ typedef struct tagmatcher_t
   FLAGS               flags;
   struct tagmatcher_t *and;
   regex_t             *regex;
+  char                *pattern;
 } TagMatcher;
 /* }}} */
 
@@ -39,6 +40,7 @@ TagClear(SubTag *t)
       TagMatcher *m = (TagMatcher *)t->matcher->data[i];
 
       if(m->regex) subSharedRegexKill(m->regex);
+      if(m->pattern) free(m->pattern);
 
       free(m);
     }
@@ -71,6 +73,15 @@ static int
 TagMatch(TagMatcher *m,
   SubClient *c)
 {
+  /* Compile deferred regex on first use */
+  if(m->pattern)
+    {
+      m->regex = subSharedRegexNew(m->pattern);
+
+      free(m->pattern);
+      m->pattern = NULL;
+    }
+
   /* Complex matching */
   if((m->regex &&
       /* Check WM_NAME */
@@ -135,14 +146,19 @@ subTagNew(char *name,
   * @param[in]  type     Matcher type
   * @param[in]  pattern  Regex
   * @param[in]  and      Logical AND with last matcher
+  * @param[in]  defer    Compile known regex on first match
+  * @retval  True   Regex is valid
+  * @retval  False  No regex
   **/
 
-void
+int
 subTagMatcherAdd(SubTag *t,
   int type,
   char *pattern,
-  int and)
+  int and,
+  int defer)
 {
+  int valid = False;
   TagMatcher *m = NULL;
   regex_t *regex = NULL;
 
@@ -150,10 +166,14 @@ subTagMatcherAdd(SubTag *t,
 
   /* Prevent emtpy regex */
   if(pattern && 0 != strlen(pattern))
-    regex = subSharedRegexNew(pattern);
+    {
+      if(!defer) regex = subSharedRegexNew(pattern);
+
+      valid = (defer || regex);
+    }
 
   /* Remove matcher types that need a regexp */
-  if(!regex)
+  if(!valid)
     type &= ~(SUB_TAG_MATCH_NAME|SUB_TAG_MATCH_INSTANCE|
       SUB_TAG_MATCH_CLASS|SUB_TAG_MATCH_ROLE);
 
@@ -162,8 +182,9 @@ subTagMatcherAdd(SubTag *t,
     {
       /* Create new matcher */
       m = MATCHER(subSharedMemoryAlloc(1, sizeof(TagMatcher)));
-      m->flags = type;
-      m->regex = regex;
+      m->flags   = type;
+      m->regex   = regex;
+      m->pattern = valid && defer ? strdup(pattern) : NULL;
 
       /* Create on demand to safe memory */
       if(NULL == t->matcher) t->matcher = subArrayNew();
@@ -177,6 +198,9 @@ subTagMatcherAdd(SubTag *t,
 
       subArrayPush(t->matcher, (void *)m);
     }
+  else if(regex) subSharedRegexKill(regex);
+
+  return valid;
 } /* }}} */
 
  /** subTagMatcherCheck {{{
@@ -241,6 +265,9 @@ subTagKill(SubTag *t)
       subArrayKill(t->matcher, False);
     }
 
+  /* Release ruby object */
+  if(t->object) subRubyRelease(t->object);
+
   free(t->name);
   free(t);
 
@@ -270,8 +297,6 @@ subTagPublish(void)
   subSharedPropertySetStrings(subtle->dpy, ROOT,
     subEwmhGet(SUB_EWMH_SUBTLE_TAG_LIST), names, i);
 
-  XSync(subtle->dpy, False); ///< Sync all changes
-
   free(names);
 
   subSharedLogDebugSubtle("publish=tags, n=%d\n", i);
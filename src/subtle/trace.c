@@ -0,0 +1,171 @@
+
+ /**
+  * @package subtle
+  *
+  * @file Trace functions
+  * @copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  **/
+
+#include <unistd.h>
+#include "subtle.h"
+
+/* Macros */
+#define TRACE_SPANS 16384                                         ///< Ring buffer size
+
+/* Typedefs */
+typedef struct tracespan_t /* {{{ */
+{
+  unsigned long long ts, dur;                                     ///< Span start and duration in usec
+  const char         *cat, *call;                                 ///< Span category and call type
+  char               name[32];                                    ///< Span name
+} TraceSpan; /* }}} */
+
+/* Globals */
+static TraceSpan *spans = NULL;
+static unsigned long nspans = 0;
+
+/* TraceEscape {{{ */
+static void
+TraceEscape(FILE *fd,
+  const char *str)
+{
+  /* Keep JSON strings valid */
+  for(; *str; str++)
+    {
+      if('"' == *str || '\\' == *str) fprintf(fd, "\\%c", *str);
+      else if(0x20 > (unsigned char)*str) fprintf(fd, "\\u%04x", *str);
+      else fputc(*str, fd);
+    }
+} /* }}} */
+
+/* TraceDump {{{ */
+static void
+TraceDump(void)
+{
+  unsigned long i, first = 0;
+  char path[64] = { 0 };
+  FILE *fd = NULL;
+
+  /* Use pid when no file was given */
+  if(!subtle->paths.trace)
+    snprintf(path, sizeof(path), "/tmp/%s-%d.trace.json",
+      PKG_NAME, (int)getpid());
+
+  if(!(fd = fopen(subtle->paths.trace ? subtle->paths.trace : path, "w")))
+    {
+      subSharedLogWarn("Failed writing trace `%s': %s\n",
+        subtle->paths.trace ? subtle->paths.trace : path, strerror(errno));
+
+      return;
+    }
+
+  /* Oldest span is next to be overwritten when the ring is full */
+  if(TRACE_SPANS < nspans) first = nspans - TRACE_SPANS;
+
+  fprintf(fd, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  for(i = first; i < nspans; i++)
+    {
+      TraceSpan *s = &spans[i % TRACE_SPANS];
+
+      fprintf(fd, "%s{\"ph\":\"X\",\"pid\":%d,\"tid\":1,\"ts\":%llu,"
+        "\"dur\":%llu,\"cat\":\"%s\",\"name\":\"", i == first ? "" : ",\n",
+        (int)getpid(), s->ts, s->dur, s->cat);
+      TraceEscape(fd, s->name);
+      fprintf(fd, "\"");
+
+      if(s->call) fprintf(fd, ",\"args\":{\"call\":\"%s\"}", s->call);
+
+      fprintf(fd, "}");
+    }
+
+  fprintf(fd, "\n]}\n");
+  fclose(fd);
+
+  printf("Trace (%s) has %lu spans\n",
+    subtle->paths.trace ? subtle->paths.trace : path,
+    nspans - first);
+} /* }}} */
+
+ /** subTraceStart {{{
+  * @brief Get start time of a span
+  * @return Returns current time in usec or \p 0 when tracing is off
+  **/
+
+unsigned long long
+subTraceStart(void)
+{
+  return spans ? subSubtleClock(CLOCK_MONOTONIC) : 0;
+} /* }}} */
+
+ /** subTraceSpan {{{
+  * @brief Record span that started at given time
+  * @param[in]  cat    Span category
+  * @param[in]  name   Span name
+  * @param[in]  call   Call type or \p NULL
+  * @param[in]  start  Start time from #subTraceStart
+  **/
+
+void
+subTraceSpan(const char *cat,
+  const char *name,
+  const char *call,
+  unsigned long long start)
+{
+  TraceSpan *s = NULL;
+
+  if(!spans || !start) return;
+
+  /* Overwrite oldest span when full */
+  s = &spans[nspans++ % TRACE_SPANS];
+
+  s->ts   = start;
+  s->dur  = subSubtleClock(CLOCK_MONOTONIC) - start;
+  s->cat  = cat;
+  s->call = call;
+
+  strncpy(s->name, name ? name : "", sizeof(s->name) - 1);
+  s->name[sizeof(s->name) - 1] = '\0';
+} /* }}} */
+
+ /** subTraceToggle {{{
+  * @brief Start tracing or write trace and stop
+  **/
+
+void
+subTraceToggle(void)
+{
+  if(spans)
+    {
+      TraceDump();
+
+      free(spans);
+      spans  = NULL;
+      nspans = 0;
+    }
+  else
+    {
+      spans = (TraceSpan *)subSharedMemoryAlloc(TRACE_SPANS,
+        sizeof(TraceSpan));
+
+      printf("Tracing started\n");
+    }
+} /* }}} */
+
+ /** subTraceFinish {{{
+  * @brief Write pending trace
+  **/
+
+void
+subTraceFinish(void)
+{
+  if(spans) subTraceToggle();
+
+  subSharedLogDebugSubtle("finish=trace\n");
+} /* }}} */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker
@@ -213,8 +213,6 @@ subTrayPublish(void)
   /* EWMH: Client list and client list stacking */
   subEwmhSetWindows(ROOT, SUB_EWMH_SUBTLE_TRAY_LIST, wins, subtle->trays->ndata);
 
-  XSync(subtle->dpy, False); ///< Sync all changes
-
   free(wins);
 
   subSharedLogDebugSubtle("publish=tray, trays=%d\n", subtle->trays->ndata);
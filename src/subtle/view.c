@@ -146,9 +146,12 @@ subViewSwitch(SubView *v,
 {
   int i, swap = -1;
   SubScreen *s1 = NULL;
+  SubAccount mark;
 
   assert(v);
 
+  subDisplayMark(&mark);
+
   /* Get working screen */
   if(!(s1 = subArrayGet(subtle->screens, sid)))
     s1 = subScreenCurrent(NULL);
@@ -184,6 +187,8 @@ subViewSwitch(SubView *v,
 
   /* Hook: Jump */
   subHookCall((SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_FOCUS), (void *)v);
+
+  subDisplayAccount(SUB_ACCOUNT_VIEW_SWITCH, &mark);
 } /* }}} */
 
  /** subViewPublish {{{
@@ -228,8 +233,6 @@ subViewPublish(void)
       /* EWMH: Current desktop */
       subEwmhSetCardinals(ROOT, SUB_EWMH_NET_CURRENT_DESKTOP, &vid, 1);
 
-      XSync(subtle->dpy, False); ///< Sync all changes
-
       free(tags);
       free(icons);
       free(names);
@@ -252,6 +255,9 @@ subViewKill(SubView *v)
   subHookCall((SUB_HOOK_TYPE_VIEW|SUB_HOOK_ACTION_KILL),
     (void *)v);
 
+  /* Release ruby object */
+  if(v->object) subRubyRelease(v->object);
+
   if(v->icon) free(v->icon);
   free(v->name);
   free(v);
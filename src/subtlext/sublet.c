@@ -11,6 +11,69 @@
 
 #include "subtlext.h"
 
+/* Typedefs {{{ */
+typedef struct subtlextsubletbatch_t
+{
+  int   nsublets, nrecords;
+  char  **sublets;
+  VALUE buf;
+} SubtlextSubletBatch;
+/* }}} */
+
+/* SubletBatchRecord {{{ */
+static int
+SubletBatchRecord(VALUE key,
+  VALUE value,
+  VALUE data)
+{
+  int id = -1;
+  char buf[20] = { 0 };
+  SubtlextSubletBatch *batch = (SubtlextSubletBatch *)data;
+
+  /* Check value type */
+  if(T_STRING != rb_type(value))
+    rb_raise(rb_eArgError, "Unexpected value-type `%s'",
+      rb_obj_classname(value));
+
+  /* Find sublet id; symbols are looked up by name */
+  if(T_SYMBOL == rb_type(key)) key = rb_sym_to_s(key);
+
+  switch(rb_type(key))
+    {
+      case T_FIXNUM: id = FIX2INT(key); break;
+      case T_STRING:
+          {
+            int i;
+
+            /* Fetch list once for all names */
+            if(!batch->sublets)
+              batch->sublets = subSharedPropertyGetStrings(display,
+                DefaultRootWindow(display), XInternAtom(display,
+                "SUBTLE_SUBLET_LIST", False), &batch->nsublets);
+
+            for(i = 0; i < batch->nsublets; i++)
+              if(0 == strcmp(batch->sublets[i], RSTRING_PTR(key))) id = i;
+          }
+        break;
+      case T_OBJECT:
+        if(rb_obj_is_instance_of(key, rb_const_get(mod, rb_intern("Sublet"))))
+          id = FIX2INT(rb_iv_get(key, "@id"));
+        break;
+      default: break;
+    }
+
+  /* Append id and data, each terminated by nul */
+  if(-1 != id)
+    {
+      rb_str_cat(batch->buf, buf, snprintf(buf, sizeof(buf), "%d", id) + 1);
+      rb_str_cat(batch->buf, RSTRING_PTR(value),
+        strlen(RSTRING_PTR(value)) + 1);
+      batch->nrecords++;
+    }
+
+  return ST_CONTINUE;
+} /* }}} */
+
 /* Singleton */
 
 /* subSubletSingFind {{{ */
@@ -115,6 +178,51 @@ subSubletSingAll(VALUE self)
   return array;
 } /* }}} */
 
+/* subSubletSingBatch {{{ */
+/*
+ * call-seq: batch(hash) -> Fixnum
+ *
+ * Set data of many Sublets at once. Keys are either a Sublet, an id or an
+ * exact name, values must be strings. All records are sent in one message
+ * and subtle renders the panels once, returns the number of sent records.
+ *
+ *  Subtlext::Sublet.batch(:mail => "2", :jobs => "idle")
+ *  => 2
+ */
+
+VALUE
+subSubletSingBatch(VALUE self,
+  VALUE value)
+{
+  SubtlextSubletBatch batch = { 0, 0, NULL, Qnil };
+
+  Check_Type(value, T_HASH);
+
+  subSubtlextConnect(NULL); ///< Implicit open connection
+
+  batch.buf = rb_str_buf_new(0);
+  rb_hash_foreach(value, SubletBatchRecord, (VALUE)&batch);
+
+  if(batch.sublets) XFreeStringList(batch.sublets);
+
+  /* Append records to concurrent writers and notify once */
+  if(0 < RSTRING_LEN(batch.buf))
+    {
+      SubMessageData data = { { 0, 0, 0, 0, 0 } };
+
+      XChangeProperty(display, DefaultRootWindow(display),
+        XInternAtom(display, "SUBTLE_SUBLET_BATCH", False),
+        XInternAtom(display, "UTF8_STRING", False), 8, PropModeAppend,
+        (unsigned char *)RSTRING_PTR(batch.buf), RSTRING_LEN(batch.buf));
+
+      subSharedMessage(display, DefaultRootWindow(display),
+        "SUBTLE_SUBLET_BATCH", data, 32, False);
+      XFlush(display);
+    }
+
+  return INT2FIX(batch.nrecords);
+} /* }}} */
+
 /* Class */
 
 /* subSubletInstantiate {{{ */
@@ -363,6 +471,57 @@ subSubletGeometryReader(VALUE self)
   return subGeometryInstantiate(px + wx, py + wy, wwidth, wheight);
 } /* }}} */
 
+/* subSubletStatsReader {{{ */
+/*
+ * call-seq: stats -> Hash or nil
+ *
+ * Get profile stats of this Sublet. Times are in microseconds unless
+ * stated otherwise, averages are rolling.
+ *
+ *  sublet.stats
+ *  => { :calls => 42, :cpu_ms => 120, :wall_ms => 130, :cpu => 2857,
+ *       :wall => 3095, :max => 9012, :allocs => 312, :render => 412 }
+ */
+
+VALUE
+subSubletStatsReader(VALUE self)
+{
+  int i;
+  unsigned long nstats = 0;
+  long *stats = NULL;
+  VALUE id = Qnil, hash = Qnil;
+  const char *keys[] = {
+    "calls", "cpu_ms", "wall_ms", "cpu", "wall", "max", "allocs", "render"
+  };
+
+  /* Check ruby object */
+  rb_check_frozen(self);
+  GET_ATTR(self, "@id", id);
+
+  subSubtlextConnect(NULL); ///< Implicit open connection
+
+  /* Fetch data */
+  if((stats = (long *)subSharedPropertyGet(display,
+      DefaultRootWindow(display), XA_CARDINAL, XInternAtom(display,
+      "SUBTLE_SUBLET_STATS", False), &nstats)))
+    {
+      /* Each sublet has a fixed number of values */
+      if((FIX2INT(id) + 1) * LENGTH(keys) <= nstats)
+        {
+          long *v = &stats[FIX2INT(id) * LENGTH(keys)];
+
+          hash = rb_hash_new();
+
+          for(i = 0; i < LENGTH(keys); i++)
+            rb_hash_aset(hash, CHAR2SYM(keys[i]), LONG2NUM(v[i]));
+        }
+
+      free(stats);
+    }
+
+  return hash;
+} /* }}} */
+
 /* subSubletToString {{{ */
 /*
  * call-seq: to_str -> String
@@ -360,6 +360,188 @@ subSubtleSingFont(VALUE self)
   return font;
 } /* }}} */
 
+/* subSubtleSingGCStats {{{ */
+/*
+ * call-seq: gc_stats -> Hash or nil
+ *
+ * Get stats of garbage collections subtle ran while idle. Times are in
+ * microseconds unless stated otherwise, averages are rolling.
+ *
+ *  Subtlext::Subtle.gc_stats
+ *  => { :runs => 12, :wall_ms => 48, :wall => 3950, :max => 6120,
+ *       :allocs => 10450 }
+ */
+
+VALUE
+subSubtleSingGCStats(VALUE self)
+{
+  int i;
+  unsigned long nstats = 0;
+  long *stats = NULL;
+  VALUE hash = Qnil;
+  const char *keys[] = { "runs", "wall_ms", "wall", "max", "allocs" };
+
+  subSubtlextConnect(NULL); ///< Implicit open connection
+
+  /* Fetch data */
+  if((stats = (long *)subSharedPropertyGet(display,
+      DefaultRootWindow(display), XA_CARDINAL, XInternAtom(display,
+      "SUBTLE_GC_STATS", False), &nstats)))
+    {
+      if(LENGTH(keys) <= nstats)
+        {
+          hash = rb_hash_new();
+
+          for(i = 0; i < LENGTH(keys); i++)
+            rb_hash_aset(hash, CHAR2SYM(keys[i]), LONG2NUM(stats[i]));
+        }
+
+      free(stats);
+    }
+
+  return hash;
+} /* }}} */
+
+/* subSubtleSingXStats {{{ */
+/*
+ * call-seq: x_stats -> Hash or nil
+ *
+ * Get X request stats of event handlers and operations of subtle. Counts
+ * of nested operations are included in their callers.
+ *
+ *  Subtlext::Subtle.x_stats
+ *  => { :map_request => { :calls => 4, :requests => 212,
+ *       :roundtrips => 36, :max => 61 }, ... }
+ */
+
+VALUE
+subSubtleSingXStats(VALUE self)
+{
+  int i, j;
+  unsigned long nstats = 0;
+  long *stats = NULL;
+  VALUE hash = Qnil;
+  const char *keys[] = { "calls", "requests", "roundtrips", "max" };
+  const char *names[] =
+  {
+    "colormap", "configure", "configure_request", "crossing", "destroy",
+    "expose", "focus", "grab", "map", "map_request", "message", "property",
+    "selection", "unmap", "screen_configure", "screen_render", "client_new",
+    "client_focus", "client_retag", "view_switch", "reload"
+  };
+
+  subSubtlextConnect(NULL); ///< Implicit open connection
+
+  /* Fetch data */
+  if((stats = (long *)subSharedPropertyGet(display,
+      DefaultRootWindow(display), XA_CARDINAL, XInternAtom(display,
+      "SUBTLE_X_STATS", False), &nstats)))
+    {
+      hash = rb_hash_new();
+
+      for(i = 0; i < LENGTH(names) &&
+          (i + 1) * LENGTH(keys) <= nstats; i++)
+        {
+          VALUE op = rb_hash_new();
+
+          for(j = 0; j < LENGTH(keys); j++)
+            rb_hash_aset(op, CHAR2SYM(keys[j]),
+              LONG2NUM(stats[i * LENGTH(keys) + j]));
+
+          rb_hash_aset(hash, CHAR2SYM(names[i]), op);
+        }
+
+      free(stats);
+    }
+
+  return hash;
+} /* }}} */
+
+/* subSubtleSingLatencyStats {{{ */
+/*
+ * call-seq: latency_stats -> Hash or nil
+ *
+ * Get event latency stats of subtle. Dispatch times are kept per event
+ * type, client messages and property changes per atom, and the age of
+ * key and button presses when subtle handled them. All times are in
+ * microseconds, percentiles are accurate within about 12%.
+ *
+ *  Subtlext::Subtle.latency_stats
+ *  => { "MapRequest" => { :count => 4, :p50 => 2303, :p99 => 9215,
+ *       :max => 8960 }, "KeyPress age" => { ... }, ... }
+ */
+
+VALUE
+subSubtleSingLatencyStats(VALUE self)
+{
+  int i;
+  unsigned long nstats = 0;
+  long *stats = NULL;
+  VALUE hash = Qnil;
+  const char *events[] =
+  {
+    NULL, NULL, "KeyPress", "KeyRelease", "ButtonPress", "ButtonRelease",
+    "MotionNotify", "EnterNotify", "LeaveNotify", "FocusIn", "FocusOut",
+    "KeymapNotify", "Expose", "GraphicsExpose", "NoExpose",
+    "VisibilityNotify", "CreateNotify", "DestroyNotify", "UnmapNotify",
+    "MapNotify", "MapRequest", "ReparentNotify", "ConfigureNotify",
+    "ConfigureRequest", "GravityNotify", "ResizeRequest", "CirculateNotify",
+    "CirculateRequest", "PropertyNotify", "SelectionClear",
+    "SelectionRequest", "SelectionNotify", "ColormapNotify", "ClientMessage",
+    "MappingNotify", "GenericEvent"
+  };
+
+  subSubtlextConnect(NULL); ///< Implicit open connection
+
+  /* Fetch data */
+  if((stats = (long *)subSharedPropertyGet(display,
+      DefaultRootWindow(display), XA_CARDINAL, XInternAtom(display,
+      "SUBTLE_LATENCY_STATS", False), &nstats)))
+    {
+      hash = rb_hash_new();
+
+      for(i = 0; i + 6 <= nstats; i += 6)
+        {
+          char buf[256] = { 0 }, *name = NULL;
+          long *v = &stats[i];
+          VALUE h = rb_hash_new();
+
+          /* Name histogram after event type or atom */
+          switch(v[0])
+            {
+              case 0:
+              case 3:
+                snprintf(buf, sizeof(buf), "%s%s",
+                  0 <= v[1] && LENGTH(events) > v[1] && events[v[1]] ?
+                  events[v[1]] : "Unknown", 3 == v[0] ? " age" : "");
+                break;
+              case 1:
+              case 2:
+                if(None != v[1]) name = XGetAtomName(display, v[1]);
+
+                snprintf(buf, sizeof(buf), "%s %s",
+                  1 == v[0] ? "ClientMessage" : "PropertyNotify",
+                  name ? name : "other");
+
+                if(name) XFree(name);
+                break;
+              default: continue;
+            }
+
+          rb_hash_aset(h, CHAR2SYM("count"), LONG2NUM(v[2]));
+          rb_hash_aset(h, CHAR2SYM("p50"),   LONG2NUM(v[3]));
+          rb_hash_aset(h, CHAR2SYM("p99"),   LONG2NUM(v[4]));
+          rb_hash_aset(h, CHAR2SYM("max"),   LONG2NUM(v[5]));
+
+          rb_hash_aset(hash, rb_str_new2(buf), h);
+        }
+
+      free(stats);
+    }
+
+  return hash;
+} /* }}} */
+
 /* subSubtleSingSpawn {{{ */
 /*
  * call-seq: spawn(cmd) -> Subtlext::Client
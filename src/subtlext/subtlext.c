@@ -20,6 +20,7 @@
 
 Display *display = NULL;
 VALUE mod = Qnil;
+static pid_t owner = 0;
 
 /* SubtlextStringify {{{ */
 static void
@@ -1120,13 +1121,24 @@ SubtlextEqualSpaceId(VALUE self,
 void
 subSubtlextConnect(char *display_string)
 {
+  char *name = display_string;
+
+  /* Drop connection inherited from parent process (e.g. sublet helpers) */
+  if(display && getpid() != owner)
+    {
+      if(!name) name = DisplayString(display);
+
+      close(ConnectionNumber(display));
+      display = NULL; ///< Still in use by parent, just leak it
+    }
+
   /* Open display */
   if(!display)
     {
-      if(!(display = XOpenDisplay(display_string)))
+      if(!(display = XOpenDisplay(name)))
         {
           rb_raise(rb_eStandardError, "Failed opening display `%s'",
-            display_string);
+            name);
         }
 
       XSetErrorHandler(subSharedLogXError);
@@ -1134,7 +1146,9 @@ subSubtlextConnect(char *display_string)
       if(!setlocale(LC_CTYPE, "")) XSupportsLocale();
 
       /* Register sweeper */
-      atexit(SubtlextSweep);
+      if(!owner) atexit(SubtlextSweep);
+
+      owner = getpid();
 
       subSharedLogDebugSubtlext("Connection opened (%s)\n",
         DisplayString(display));
@@ -1927,6 +1941,9 @@ Init_subtlext(void)
   rb_define_singleton_method(subtle, "quit",          subSubtleSingQuit,          0);
   rb_define_singleton_method(subtle, "colors",        subSubtleSingColors,        0);
   rb_define_singleton_method(subtle, "font",          subSubtleSingFont,          0);
+  rb_define_singleton_method(subtle, "gc_stats",      subSubtleSingGCStats,       0);
+  rb_define_singleton_method(subtle, "x_stats",       subSubtleSingXStats,        0);
+  rb_define_singleton_method(subtle, "latency_stats", subSubtleSingLatencyStats,  0);
   rb_define_singleton_method(subtle, "spawn",         subSubtleSingSpawn,         1);
 
   /* Aliases */
@@ -1949,6 +1966,7 @@ Init_subtlext(void)
   /* Singleton methods */
   rb_define_singleton_method(sublet, "find", subSubletSingFind, 1);
   rb_define_singleton_method(sublet, "all",  subSubletSingAll,  0);
+  rb_define_singleton_method(sublet, "batch", subSubletSingBatch, 1);
 
   /* General methods */
   rb_define_method(sublet, "<=>",    SubtlextEqualSpaceId, 1);
@@ -1962,6 +1980,7 @@ Init_subtlext(void)
   rb_define_method(sublet, "data",       subSubletDataReader,     0);
   rb_define_method(sublet, "data=",      subSubletDataWriter,     1);
   rb_define_method(sublet, "geometry",   subSubletGeometryReader, 0);
+  rb_define_method(sublet, "stats",      subSubletStatsReader,    0);
   rb_define_method(sublet, "show",       subSubletVisibilityShow, 0);
   rb_define_method(sublet, "hide",       subSubletVisibilityHide, 0);
   rb_define_method(sublet, "to_str",     subSubletToString,       0);
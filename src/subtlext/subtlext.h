@@ -173,6 +173,7 @@ VALUE subScreenToString(VALUE self);                              ///< Screen to
 /* Singleton */
 VALUE subSubletSingFind(VALUE self, VALUE value);                 ///< Find sublet
 VALUE subSubletSingAll(VALUE self);                               ///< Get all sublets
+VALUE subSubletSingBatch(VALUE self, VALUE value);                ///< Set data of many sublets
 
 /* Class */
 VALUE subSubletInstantiate(char *name);                           ///< Instantiate sublet
@@ -183,6 +184,7 @@ VALUE subSubletDataWriter(VALUE self, VALUE value);               ///< Set suble
 VALUE subSubletVisibilityShow(VALUE self);                        ///< Show sublet
 VALUE subSubletVisibilityHide(VALUE self);                        ///< Hide sublet
 VALUE subSubletGeometryReader(VALUE self);                        ///< Get sublet geometry
+VALUE subSubletStatsReader(VALUE self);                           ///< Get sublet stats
 VALUE subSubletToString(VALUE self);                              ///< Sublet to string
 VALUE subSubletKill(VALUE self);                                  ///< Kill sublet
 /* }}} */
@@ -199,6 +201,9 @@ VALUE subSubtleSingRestart(VALUE self);                           ///< Restart s
 VALUE subSubtleSingQuit(VALUE self);                              ///< Quit subtle
 VALUE subSubtleSingColors(VALUE self);                            ///< Get colors
 VALUE subSubtleSingFont(VALUE self);                              ///< Get font
+VALUE subSubtleSingGCStats(VALUE self);                           ///< Get GC stats
+VALUE subSubtleSingXStats(VALUE self);                            ///< Get X request stats
+VALUE subSubtleSingLatencyStats(VALUE self);                      ///< Get latency stats
 VALUE subSubtleSingSpawn(VALUE self, VALUE cmd);                  ///< Spawn command
 /* }}} */
 
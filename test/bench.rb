@@ -0,0 +1,282 @@
+#!/usr/bin/ruby
+#
+# @package test
+#
+# @file Run benchmarks against Xvfb
+# @author Christoph Kappel <unexist@dorfelite.net>
+# @version $Id$
+#
+# This program can be distributed under the terms of the GNU GPLv2.
+# See the file COPYING for details.
+#
+# Every scenario prints one JSON line to stdout:
+#
+#  {"scenario":"map_destroy","n":500,"wall":1.234,"requests":12000,
+#   "roundtrips":2100,"rss":10240,"hwm":11264}
+#
+# Wall time is in seconds, RSS and peak RSS (hwm) in kB. Requests and
+# round trips are the deltas of all event handlers from x_stats and
+# include one render message per measurement. Scenarios can be selected
+# by name as arguments. The loadgen scenario replays loadgen.conf with
+# the loadgen helper when it is built.
+#
+
+# Configuration
+subtle   = "../subtle"
+subtlext = "../subtlext.so"
+config   = "../data/subtle.rb"
+sublets  = "./bench"
+display  = ":11"
+
+begin
+  require "mkmf"
+  require "json"
+  require "gtk2/base"
+  require subtlext
+rescue LoadError => missing
+  puts <<EOF
+>>> ERROR: Couldn't find the gem `#{missing}'
+>>>        Please install it with following command:
+>>>        gem install #{missing}
+EOF
+  exit(1)
+end
+
+# Find Xvfb
+if((xvfb = find_executable0("Xvfb")).nil?)
+  raise "Xvfb not found in path"
+end
+
+xrandr  = find_executable0("xrandr")
+loadgen = "./loadgen"
+
+ ## wait {{{
+ # Wait until block is true or timeout is reached
+ ##
+
+def wait(timeout = 10.0)
+  deadline = Time.now + timeout
+
+  until(yield)
+    Gtk.main_iteration_do(false) while(Gtk.events_pending?)
+
+    raise "Timeout" if(Time.now > deadline)
+
+    sleep(0.01)
+  end
+end # }}}
+
+ ## measure {{{
+ # Fetch X stats and memory usage of subtle
+ ##
+
+def measure(pid)
+  ret = { :requests => 0, :roundtrips => 0 }
+
+  # Stats are published at most once per second and need a loop iteration
+  sleep(1.1)
+  Subtlext::Subtle.render
+  sleep(0.2)
+
+  (Subtlext::Subtle.x_stats || {}).each do |name, op|
+    # Operations are included in the handlers that call them
+    next if([ :screen_configure, :screen_render, :client_new,
+      :client_focus, :client_retag, :view_switch ].include?(name))
+
+    ret[:requests]   += op[:requests]
+    ret[:roundtrips] += op[:roundtrips]
+  end
+
+  # Memory usage
+  File.readlines("/proc/#{pid}/status").each do |line|
+    case line
+      when /^VmRSS:\s+(\d+)/ then ret[:rss] = $~[1].to_i
+      when /^VmHWM:\s+(\d+)/ then ret[:hwm] = $~[1].to_i
+    end
+  end
+
+  ret
+end # }}}
+
+ ## messages {{{
+ # Get count of handled client messages of given type
+ ##
+
+def messages(type)
+  stats = (Subtlext::Subtle.latency_stats || {})["ClientMessage " + type]
+
+  stats ? stats[:count] : 0
+end # }}}
+
+ ## spawn_clients {{{
+ # Create and map given number of windows
+ ##
+
+def spawn_clients(n)
+  count   = Subtlext::Client.all.size
+  windows = n.times.map do |i|
+    w = Gtk::Window.new
+    w.title = "bench%d" % [ i ]
+    w.set_wmclass("bench", "Bench")
+    w.set_default_size(100, 100)
+    w.show_all
+
+    w
+  end
+
+  wait { count + n <= Subtlext::Client.all.size }
+
+  windows
+end # }}}
+
+ ## destroy_clients {{{
+ # Destroy windows
+ ##
+
+def destroy_clients(windows)
+  count = Subtlext::Client.all.size
+
+  windows.each(&:destroy)
+
+  wait { count - windows.size >= Subtlext::Client.all.size }
+end # }}}
+
+# Scenarios
+scenarios = {
+  "map_destroy" => [ 500, lambda { |n|
+    destroy_clients(spawn_clients(n))
+  } ],
+  "view_switch" => [ 1000, lambda { |n|
+    windows = spawn_clients(200)
+    views   = Subtlext::View.all
+
+    n.times { |i| views[i % views.size].jump }
+    wait { views[(n - 1) % views.size].current? }
+
+    destroy_clients(windows)
+  } ],
+  "retag" => [ 1000, lambda { |n|
+    windows = spawn_clients(200)
+    clients = Subtlext::Client["bench"] || []
+    clients = [ clients ] unless(clients.is_a?(Array))
+    tags    = Subtlext::Tag.all
+    count   = messages("SUBTLE_CLIENT_TAGS") + messages("SUBTLE_CLIENT_RETAG")
+
+    n.times do |i|
+      c = clients[i % clients.size]
+
+      i.even? ? c.tags = [ tags[i % tags.size] ] : c.retag
+    end
+
+    # Wait until subtle handled all messages
+    wait(30.0) do
+      Subtlext::Subtle.render
+      sleep(0.5)
+
+      count + n <= messages("SUBTLE_CLIENT_TAGS") +
+        messages("SUBTLE_CLIENT_RETAG")
+    end
+
+    destroy_clients(windows)
+  } ],
+  "sublet_data" => [ 5000, lambda { |n|
+    sublet = Subtlext::Sublet[:data]
+    count  = messages("SUBTLE_SUBLET_DATA")
+
+    n.times { |i| sublet.data = "bench %d" % [ i ] }
+
+    # Latency stats are published with a delay
+    wait(30.0) do
+      Subtlext::Subtle.render
+      sleep(0.5)
+
+      count + n <= messages("SUBTLE_SUBLET_DATA")
+    end
+  } ],
+  "focus" => [ 2000, lambda { |n|
+    windows = spawn_clients(20)
+    clients = Subtlext::Client.visible
+
+    n.times { |i| clients[i % clients.size].focus }
+    wait { clients[(n - 1) % clients.size].has_focus? }
+
+    destroy_clients(windows)
+  } ],
+  "randr" => [ 50, lambda { |n|
+    sizes = [ "1024x768", "800x600" ]
+
+    n.times do |i|
+      system("#{xrandr} -d #{ENV["DISPLAY"]} --fb #{sizes[i % 2]}")
+
+      wait { sizes[i % 2] == "%dx%d" % [
+        Subtlext::Screen[0].geometry.width,
+        Subtlext::Screen[0].geometry.height ] }
+    end
+  } ],
+  "loadgen" => [ 1, lambda { |n|
+    count = Subtlext::Client.all.size
+
+    n.times do
+      IO.popen([ loadgen, "-d", ENV["DISPLAY"], "loadgen.conf" ]) do |io|
+        $stderr.puts(io.read)
+      end
+    end
+
+    wait { count >= Subtlext::Client.all.size }
+  } ]
+}
+
+# Skip scenarios
+scenarios.delete("randr") if(xrandr.nil?)
+scenarios.delete("loadgen") unless(File.executable?(loadgen))
+scenarios.select! { |k, v| ARGV.include?(k) } unless(ARGV.empty?)
+
+# Start Xvfb and subtle
+ENV["DISPLAY"] = display
+
+xpid = Process.spawn("#{xvfb} #{display} -screen 0 1024x768x16 " +
+  "+extension RANDR", [ :out, :err ] => "/dev/null")
+
+sleep 1
+
+spid = Process.spawn("#{subtle} -d #{display} -c #{config} -s #{sublets}",
+  [ :out, :err ] => "/dev/null")
+
+begin
+  sleep 1
+
+  Gtk.init([ "--display=%s" % [ display ] ])
+
+  Subtlext::Subtle.display = display
+
+  wait { Subtlext::Subtle.running? }
+
+  # Run scenarios
+  scenarios.each do |name, (n, scenario)|
+    before = measure(spid)
+    start  = Time.now
+
+    scenario.call(n)
+
+    wall  = Time.now - start
+    after = measure(spid)
+
+    puts JSON.generate(
+      :scenario   => name,
+      :n          => n,
+      :wall       => wall.round(4),
+      :requests   => after[:requests] - before[:requests],
+      :roundtrips => after[:roundtrips] - before[:roundtrips],
+      :rss        => after[:rss],
+      :hwm        => after[:hwm]
+    )
+    $stdout.flush
+  end
+ensure
+  [ spid, xpid ].each do |pid|
+    Process.kill(:TERM, pid) rescue nil
+    Process.wait(pid) rescue nil
+  end
+end
+
+# vim:ts=2:bs=2:sw=2:et:fdm=marker
@@ -0,0 +1,7 @@
+configure :data do |s|
+  s.data = ""
+end
+
+on :data do |s, str|
+  s.data = str.to_s
+end
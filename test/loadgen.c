@@ -0,0 +1,462 @@
+
+ /**
+  * @package test
+  *
+  * @file Synthetic client load generator
+  * @copyright (c) 2005-2011 Christoph Kappel <unexist@dorfelite.net>
+  * @version $Id$
+  *
+  * This program can be distributed under the terms of the GNU GPLv2.
+  * See the file COPYING for details.
+  *
+  * Scenario files consist of one setting per line:
+  *
+  *  seed 42
+  *  duration 10
+  *  hz 100
+  *  clients 100 instance=xterm class=XTerm name=2 hints=0.5 urgent=0.1 state=0.2
+  *  tray 8
+  *
+  * Rates are changes per client and second. Changes are scheduled per
+  * tick from a fixed seed, so the request stream is identical between
+  * runs regardless of how fast the window manager answers.
+  **/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <time.h>
+#include <X11/Xlib.h>
+#include <X11/Xutil.h>
+#include <X11/Xatom.h>
+
+/* Macros */
+#define LOAD_GROUPS 32                                            ///< Max client groups
+#define LOAD_LINE   512                                           ///< Max scenario line length
+
+#define LOAD_NAME   0                                             ///< WM_NAME changes
+#define LOAD_HINTS  1                                             ///< Size hint changes and resizes
+#define LOAD_URGENT 2                                             ///< Urgency flips
+#define LOAD_STATE  3                                             ///< _NET_WM_STATE requests
+#define LOAD_TOTAL  4
+
+/* Typedefs */
+typedef struct loadgroup_t /* {{{ */
+{
+  int    count;                                                   ///< Group client count
+  char   instance[64], klass[64];                                 ///< Group WM_CLASS
+  double rates[LOAD_TOTAL], pending[LOAD_TOTAL];                  ///< Group change rates and fractions
+  Window *wins;                                                   ///< Group windows
+} LoadGroup; /* }}} */
+
+/* Globals */
+static Display *dpy = NULL;
+static LoadGroup groups[LOAD_GROUPS];
+static int ngroups = 0, ntray = 0, duration = 10, hz = 100;
+static unsigned long seed = 1, changes[LOAD_TOTAL] = { 0 };
+static Window *tray = NULL;
+static Atom atoms[8];
+
+enum { NET_WM_STATE, NET_WM_STATE_FULLSCREEN, NET_WM_STATE_ABOVE,
+  NET_WM_STATE_STICKY, NET_WM_NAME, UTF8_STRING, XEMBED_INFO,
+  NET_SYSTEM_TRAY_OPCODE };
+
+/* LoadRandom {{{ */
+static unsigned long
+LoadRandom(void)
+{
+  seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+
+  return seed >> 33;
+} /* }}} */
+
+/* LoadClock {{{ */
+static unsigned long long
+LoadClock(void)
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec * 1000000ULL + ts.tv_nsec / 1000;
+} /* }}} */
+
+/* LoadParse {{{ */
+static int
+LoadParse(const char *file)
+{
+  int lineno = 0;
+  char line[LOAD_LINE], *key = NULL, *tok = NULL;
+  FILE *fd = NULL;
+
+  if(!(fd = fopen(file, "r")))
+    {
+      perror(file);
+
+      return False;
+    }
+
+  while(fgets(line, sizeof(line), fd))
+    {
+      lineno++;
+
+      /* Skip comments and empty lines */
+      if((tok = strchr(line, '#'))) *tok = '\0';
+      if(!(key = strtok(line, " \t\n"))) continue;
+
+      tok = strtok(NULL, " \t\n");
+
+      if(0 == strcmp(key, "seed") && tok) seed = strtoul(tok, NULL, 0);
+      else if(0 == strcmp(key, "duration") && tok) duration = atoi(tok);
+      else if(0 == strcmp(key, "hz") && tok) hz = atoi(tok);
+      else if(0 == strcmp(key, "tray") && tok) ntray = atoi(tok);
+      else if(0 == strcmp(key, "clients") && tok && LOAD_GROUPS > ngroups)
+        {
+          LoadGroup *g = &groups[ngroups++];
+
+          memset(g, 0, sizeof(LoadGroup));
+          g->count = atoi(tok);
+          strcpy(g->instance, "loadgen");
+          strcpy(g->klass, "Loadgen");
+
+          /* Parse key=value options */
+          while((tok = strtok(NULL, " \t\n")))
+            {
+              char *value = strchr(tok, '=');
+
+              if(!value) continue;
+
+              *value++ = '\0';
+
+              if(0 == strcmp(tok, "instance"))
+                snprintf(g->instance, sizeof(g->instance), "%s", value);
+              else if(0 == strcmp(tok, "class"))
+                snprintf(g->klass, sizeof(g->klass), "%s", value);
+              else if(0 == strcmp(tok, "name"))   g->rates[LOAD_NAME]   = atof(value);
+              else if(0 == strcmp(tok, "hints"))  g->rates[LOAD_HINTS]  = atof(value);
+              else if(0 == strcmp(tok, "urgent")) g->rates[LOAD_URGENT] = atof(value);
+              else if(0 == strcmp(tok, "state"))  g->rates[LOAD_STATE]  = atof(value);
+              else fprintf(stderr, "%s:%d: Unknown option `%s'\n", file, lineno, tok);
+            }
+        }
+      else fprintf(stderr, "%s:%d: Unknown setting `%s'\n", file, lineno, key);
+    }
+
+  fclose(fd);
+
+  return 0 < hz && 0 <= duration;
+} /* }}} */
+
+/* LoadName {{{ */
+static void
+LoadName(Window win,
+  int idx)
+{
+  char buf[64];
+
+  snprintf(buf, sizeof(buf), "loadgen %d - %lu", idx, LoadRandom() % 100000);
+
+  /* Set both legacy and EWMH name */
+  XStoreName(dpy, win, buf);
+  XChangeProperty(dpy, win, atoms[NET_WM_NAME], atoms[UTF8_STRING], 8,
+    PropModeReplace, (unsigned char *)buf, strlen(buf));
+} /* }}} */
+
+/* LoadHints {{{ */
+static void
+LoadHints(Window win)
+{
+  XSizeHints *hints = XAllocSizeHints();
+
+  /* Change hints and request a matching size */
+  hints->flags      = PMinSize|PResizeInc|PBaseSize;
+  hints->min_width  = 50 + LoadRandom() % 100;
+  hints->min_height = 50 + LoadRandom() % 100;
+  hints->width_inc  = 1 + LoadRandom() % 10;
+  hints->height_inc = 1 + LoadRandom() % 20;
+  hints->base_width = hints->base_height = 4;
+
+  XSetWMNormalHints(dpy, win, hints);
+  XResizeWindow(dpy, win, hints->min_width + LoadRandom() % 400,
+    hints->min_height + LoadRandom() % 300);
+
+  XFree(hints);
+} /* }}} */
+
+/* LoadUrgent {{{ */
+static void
+LoadUrgent(Window win)
+{
+  XWMHints *hints = NULL;
+
+  /* Flip urgency hint */
+  if((hints = XGetWMHints(dpy, win)))
+    {
+      hints->flags ^= XUrgencyHint;
+      XSetWMHints(dpy, win, hints);
+      XFree(hints);
+    }
+} /* }}} */
+
+/* LoadState {{{ */
+static void
+LoadState(Window win)
+{
+  XEvent ev;
+
+  /* Toggle a random state like a client would */
+  memset(&ev, 0, sizeof(ev));
+  ev.xclient.type         = ClientMessage;
+  ev.xclient.window       = win;
+  ev.xclient.message_type = atoms[NET_WM_STATE];
+  ev.xclient.format       = 32;
+  ev.xclient.data.l[0]    = 2; ///< _NET_WM_STATE_TOGGLE
+  ev.xclient.data.l[1]    = atoms[NET_WM_STATE_FULLSCREEN + LoadRandom() % 3];
+  ev.xclient.data.l[3]    = 1; ///< Source is application
+
+  XSendEvent(dpy, DefaultRootWindow(dpy), False,
+    SubstructureNotifyMask|SubstructureRedirectMask, &ev);
+} /* }}} */
+
+/* LoadClients {{{ */
+static void
+LoadClients(LoadGroup *g)
+{
+  int i;
+  XClassHint klass;
+  XWMHints hints;
+  XSetWindowAttributes sattrs;
+
+  g->wins = (Window *)calloc(g->count, sizeof(Window));
+
+  klass.res_name  = g->instance;
+  klass.res_class = g->klass;
+
+  hints.flags = InputHint;
+  hints.input = True;
+
+  sattrs.background_pixel = BlackPixel(dpy, DefaultScreen(dpy));
+
+  for(i = 0; i < g->count; i++)
+    {
+      g->wins[i] = XCreateWindow(dpy, DefaultRootWindow(dpy),
+        0, 0, 100 + LoadRandom() % 300, 100 + LoadRandom() % 200, 0,
+        CopyFromParent, InputOutput, CopyFromParent, CWBackPixel, &sattrs);
+
+      XSetClassHint(dpy, g->wins[i], &klass);
+      XSetWMHints(dpy, g->wins[i], &hints);
+      LoadName(g->wins[i], i);
+      LoadHints(g->wins[i]);
+
+      XMapWindow(dpy, g->wins[i]);
+    }
+} /* }}} */
+
+/* LoadTray {{{ */
+static void
+LoadTray(void)
+{
+  int i;
+  char buf[32];
+  long info[2] = { 0, 1 }; ///< XEmbed version and mapped flag
+  Window owner = None;
+
+  snprintf(buf, sizeof(buf), "_NET_SYSTEM_TRAY_S%d", DefaultScreen(dpy));
+
+  if(None == (owner = XGetSelectionOwner(dpy, XInternAtom(dpy, buf, False))))
+    {
+      fprintf(stderr, "No tray found\n");
+
+      return;
+    }
+
+  tray = (Window *)calloc(ntray, sizeof(Window));
+
+  /* Create icons and ask tray to dock them */
+  for(i = 0; i < ntray; i++)
+    {
+      XEvent ev;
+
+      tray[i] = XCreateSimpleWindow(dpy, DefaultRootWindow(dpy),
+        0, 0, 16, 16, 0, 0, WhitePixel(dpy, DefaultScreen(dpy)));
+
+      XChangeProperty(dpy, tray[i], atoms[XEMBED_INFO], atoms[XEMBED_INFO],
+        32, PropModeReplace, (unsigned char *)info, 2);
+
+      memset(&ev, 0, sizeof(ev));
+      ev.xclient.type         = ClientMessage;
+      ev.xclient.window       = owner;
+      ev.xclient.message_type = atoms[NET_SYSTEM_TRAY_OPCODE];
+      ev.xclient.format       = 32;
+      ev.xclient.data.l[0]    = CurrentTime;
+      ev.xclient.data.l[1]    = 0; ///< SYSTEM_TRAY_REQUEST_DOCK
+      ev.xclient.data.l[2]    = tray[i];
+
+      XSendEvent(dpy, owner, False, NoEventMask, &ev);
+    }
+} /* }}} */
+
+/* LoadTick {{{ */
+static void
+LoadTick(void)
+{
+  int i, j;
+
+  for(i = 0; i < ngroups; i++)
+    {
+      LoadGroup *g = &groups[i];
+
+      if(0 == g->count) continue;
+
+      for(j = 0; j < LOAD_TOTAL; j++)
+        {
+          /* Carry fractions over to the next tick */
+          g->pending[j] += g->rates[j] * g->count / hz;
+
+          for(; 1.0 <= g->pending[j]; g->pending[j] -= 1.0)
+            {
+              int idx = LoadRandom() % g->count;
+
+              switch(j)
+                {
+                  case LOAD_NAME:   LoadName(g->wins[idx], idx); break;
+                  case LOAD_HINTS:  LoadHints(g->wins[idx]);     break;
+                  case LOAD_URGENT: LoadUrgent(g->wins[idx]);    break;
+                  case LOAD_STATE:  LoadState(g->wins[idx]);     break;
+                }
+
+              changes[j]++;
+            }
+        }
+    }
+
+  XFlush(dpy);
+
+  /* Drain events, we don't select any but errors may queue up */
+  while(XPending(dpy))
+    {
+      XEvent ev;
+
+      XNextEvent(dpy, &ev);
+    }
+} /* }}} */
+
+/* LoadError {{{ */
+static int
+LoadError(Display *display,
+  XErrorEvent *ev)
+{
+  /* Windows may vanish when the window manager kills them */
+  return 0;
+} /* }}} */
+
+/* LoadUsage {{{ */
+static void
+LoadUsage(void)
+{
+  printf("Usage: loadgen [OPTIONS] SCENARIO\n\n" \
+         "Options:\n" \
+         "  -d, --display=DISPLAY   Connect to DISPLAY (default: $DISPLAY)\n" \
+         "  -s, --seed=SEED         Override scenario seed\n" \
+         "  -h, --help              Show this help and exit\n\n" \
+         "Please report bugs at %s\n",
+         "http://subforge.org/projects/subtle/issues");
+} /* }}} */
+
+/* main {{{ */
+int
+main(int argc,
+  char *argv[])
+{
+  int c, i, tick, ticks;
+  char *display = NULL, *override = NULL;
+  unsigned long long start = 0, next = 0, now = 0;
+  char *names[] = { "_NET_WM_STATE", "_NET_WM_STATE_FULLSCREEN",
+    "_NET_WM_STATE_ABOVE", "_NET_WM_STATE_STICKY", "_NET_WM_NAME",
+    "UTF8_STRING", "_XEMBED_INFO", "_NET_SYSTEM_TRAY_OPCODE" };
+  const struct option long_options[] =
+  {
+    { "display", required_argument, 0, 'd' },
+    { "seed",    required_argument, 0, 's' },
+    { "help",    no_argument,       0, 'h' },
+    { 0, 0, 0, 0}
+  };
+
+  /* Parse arguments */
+  while(-1 != (c = getopt_long(argc, argv, "d:s:h", long_options, NULL)))
+    {
+      switch(c)
+        {
+          case 'd': display  = optarg; break;
+          case 's': override = optarg; break;
+          case 'h': LoadUsage();       return 0;
+          case '?':
+            printf("Try `loadgen --help' for more information\n");
+            return -1;
+        }
+    }
+
+  if(optind >= argc || !LoadParse(argv[optind]))
+    {
+      LoadUsage();
+
+      return -1;
+    }
+
+  if(override) seed = strtoul(override, NULL, 0);
+
+  if(!(dpy = XOpenDisplay(display)))
+    {
+      fprintf(stderr, "Cannot open display `%s'\n", XDisplayName(display));
+
+      return -1;
+    }
+
+  XSetErrorHandler(LoadError);
+  XInternAtoms(dpy, names, 8, False, atoms);
+
+  /* Create clients and tray icons */
+  start = LoadClock();
+
+  for(i = 0; i < ngroups; i++) LoadClients(&groups[i]);
+  if(0 < ntray) LoadTray();
+
+  XSync(dpy, False);
+
+  /* Run fixed number of ticks and wait only when ahead of time */
+  ticks = duration * hz;
+  next  = LoadClock();
+
+  for(tick = 0; tick < ticks; tick++)
+    {
+      LoadTick();
+
+      next += 1000000ULL / hz;
+
+      if((now = LoadClock()) < next) usleep(next - now);
+    }
+
+  XSync(dpy, False);
+
+  printf("{\"ticks\":%d,\"wall\":%.4f,\"name\":%lu,\"hints\":%lu,"
+    "\"urgent\":%lu,\"state\":%lu,\"tray\":%d}\n", ticks,
+    (LoadClock() - start) / 1000000.0, changes[LOAD_NAME],
+    changes[LOAD_HINTS], changes[LOAD_URGENT], changes[LOAD_STATE],
+    tray ? ntray : 0);
+
+  /* Tidy up */
+  for(i = 0; i < ngroups; i++)
+    {
+      if(groups[i].wins) free(groups[i].wins);
+    }
+
+  if(tray) free(tray);
+
+  XCloseDisplay(dpy);
+
+  return 0;
+} /* }}} */
+
+// vim:ts=2:bs=2:sw=2:et:fdm=marker